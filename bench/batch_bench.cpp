@@ -0,0 +1,156 @@
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <fmt/format.h>
+#include <sys/resource.h>
+
+#include "arena.hpp"
+#include "batch.hpp"
+#include "input_source.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "simplifier.hpp"
+
+namespace
+{
+template<typename F>
+double time(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+double max_rss_mib()
+{
+    rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<double>(usage.ru_maxrss) / 1024;
+}
+
+/**
+ * Generates `count' random expressions, one per line, a block at a time,
+ * so that the input does not have to fit in memory
+ */
+class generated_input final : public input_source
+{
+public:
+    generated_input(std::size_t count, std::size_t variables)
+        : input_source()
+        , rng_(42)
+        , count_(count)
+        , variables_(variables)
+        , buffer_()
+        , bytes_(0)
+    {
+    }
+
+    [[nodiscard]] std::string_view next(std::size_t keep) override
+    {
+        buffer_.erase(0, buffer_.size() - keep);
+        while (count_ > 0 && buffer_.size() < keep + input_buffered::DEFAULT_BLOCK_SIZE)
+        {
+            append_tree(6);
+            buffer_ += '\n';
+            count_--;
+        }
+        bytes_ += buffer_.size() - keep;
+        return buffer_;
+    }
+
+    [[nodiscard]] std::size_t bytes() const noexcept
+    {
+        return bytes_;
+    }
+
+private:
+    std::mt19937 rng_;
+    std::size_t count_;
+    std::size_t variables_;
+    std::string buffer_;
+    std::size_t bytes_;
+
+    void append_tree(std::size_t depth)
+    {
+        if (rng_() % 4 == 0)
+            buffer_ += '!';
+
+        if (depth == 0 || rng_() % 5 == 0)
+        {
+            buffer_ += fmt::format("v{}", rng_() % variables_);
+            return;
+        }
+
+        buffer_ += '(';
+        append_tree(depth - 1);
+        buffer_ += rng_() % 2 == 0 ? " && " : " || ";
+        append_tree(depth - 1);
+        buffer_ += ')';
+    }
+};
+
+/**
+ * Processes the input the way the interactive mode does, printing both
+ * forms of every expression and flushing after each
+ */
+void verbose(input_source& in, std::ostream& out)
+{
+    expression_arena arena;
+    lexer lex(in);
+    parser par(lex, arena);
+
+    for (;;)
+    {
+        auto expr = par.parse_expression();
+        if (expr == nullptr)
+            return;
+        out << fmt::format("{0:d}\n{0}", *expr) << std::endl;
+
+        const arena_scope scope(arena);
+        auto final = make_unary(expression_unary::kind::NOT, to_nnf(std::move(expr), true));
+        out << fmt::format("{0:d}\n{0}", *final) << std::endl;
+    }
+}
+
+void bench_batch(std::size_t count)
+{
+    std::ofstream null("/dev/null");
+    generated_input in(count, 1000);
+    const auto batch_s = time([&] { (void)run_batch(in, null, false); });
+
+    const auto mib = static_cast<double>(in.bytes()) / (1024 * 1024);
+    std::cout << fmt::format(
+        "batch   {:>8} exprs {:>7.1f} MiB  {:>5.1f} MiB/s  max rss {:>6.1f} MiB\n",
+        count,
+        mib,
+        mib / batch_s,
+        max_rss_mib());
+}
+
+void bench_verbose(std::size_t count)
+{
+    std::ofstream null("/dev/null");
+    generated_input in(count, 1000);
+    const auto verbose_s = time([&] { verbose(in, null); });
+
+    const auto mib = static_cast<double>(in.bytes()) / (1024 * 1024);
+    std::cout << fmt::format(
+        "verbose {:>8} exprs {:>7.1f} MiB  {:>5.1f} MiB/s  max rss {:>6.1f} MiB\n",
+        count,
+        mib,
+        mib / verbose_s,
+        max_rss_mib());
+}
+} // namespace
+
+int main()
+{
+    // Batch runs come first, since the interactive mode never releases
+    // the structures it interns
+    for (const std::size_t count : {10000, 100000, 1000000})
+        bench_batch(count);
+    bench_verbose(100000);
+}
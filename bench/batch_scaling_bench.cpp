@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <fmt/format.h>
+
+#include "batch.hpp"
+#include "input_source.hpp"
+
+namespace
+{
+// Every job count is timed this many times, and the best run is kept
+constexpr std::size_t REPEATS = 3;
+
+template<typename F>
+double time(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void append_tree(std::string& text, std::size_t depth, std::size_t variables, std::mt19937& rng)
+{
+    if (rng() % 4 == 0)
+        text += '!';
+
+    if (depth == 0 || rng() % 5 == 0)
+    {
+        text += fmt::format("v{}", rng() % variables);
+        return;
+    }
+
+    text += '(';
+    append_tree(text, depth - 1, variables, rng);
+    text += rng() % 2 == 0 ? " && " : " || ";
+    append_tree(text, depth - 1, variables, rng);
+    text += ')';
+}
+
+/**
+ * Generates `count' random expressions of up to `depth' levels, one per
+ * line
+ */
+std::string generate(std::size_t count, std::size_t depth)
+{
+    std::mt19937 rng(42);
+    std::string text;
+    for (std::size_t i = 0; i < count; i++)
+    {
+        append_tree(text, depth, 1000, rng);
+        text += '\n';
+    }
+    return text;
+}
+
+/**
+ * Runs `run_batch' on the same in-memory input with every number of jobs
+ * from 1 to `max_jobs', reporting the speedup over a single job
+ *
+ * The output of every run is checked against the one of a single job.
+ */
+void run(const std::string& name, const std::string& text, std::size_t max_jobs)
+{
+    const auto mib = static_cast<double>(text.size()) / (1024 * 1024);
+
+    std::string expected;
+    double single_s = 0;
+    for (std::size_t jobs = 1; jobs <= max_jobs; jobs++)
+    {
+        auto best_s = 0.0;
+        for (std::size_t repeat = 0; repeat < REPEATS; repeat++)
+        {
+            std::ostringstream out;
+            input_string in(text);
+            const auto batch_s = time([&] { (void)run_batch(in, out, false, jobs); });
+            best_s = repeat == 0 ? batch_s : std::min(best_s, batch_s);
+
+            if (jobs == 1 && repeat == 0)
+                expected = out.str();
+            else if (out.str() != expected)
+                std::cerr << fmt::format("{}: output differs with {} jobs\n", name, jobs);
+        }
+        if (jobs == 1)
+            single_s = best_s;
+
+        std::cout << fmt::format(
+            "{:<6} jobs {:>3}  {:>6.1f} MiB  {:>7.1f} MiB/s  speedup {:>5.2f}  "
+            "efficiency {:>3.0f}%\n",
+            name,
+            jobs,
+            mib,
+            mib / best_s,
+            single_s / best_s,
+            100 * single_s / best_s / static_cast<double>(jobs));
+    }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const auto count = argc > 1 ? std::stoul(argv[1]) : 200'000UL;
+    const auto cores = static_cast<std::size_t>(std::max(1U, std::thread::hardware_concurrency()));
+    const auto max_jobs = argc > 2 ? std::stoul(argv[2]) : cores;
+
+    // Small expressions stress the hand-off of chunks, large ones the
+    // work inside them
+    run("small", generate(count, 4), max_jobs);
+    run("large", generate(count / 8, 9), max_jobs);
+}
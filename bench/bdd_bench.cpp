@@ -0,0 +1,124 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "bdd.hpp"
+#include "expression.hpp"
+
+namespace
+{
+using binary_kind = expression_binary::kind;
+
+template<typename F>
+double time(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Builds (a0 AND b0) OR ... OR (an AND bn), whose diagram is linear with
+ * the pairs interleaved and exponential with all the a's first
+ */
+std::unique_ptr<expression> pairs(std::size_t n)
+{
+    std::unique_ptr<expression> expr;
+    for (std::size_t i = 0; i < n; i++)
+    {
+        std::unique_ptr<expression> term = make_binary(
+            binary_kind::AND,
+            make_identifier(fmt::format("a{}", i)),
+            make_identifier(fmt::format("b{}", i)));
+        expr = expr == nullptr ? std::move(term)
+                               : make_binary(binary_kind::OR, std::move(term), std::move(expr));
+    }
+    return expr;
+}
+
+std::unique_ptr<expression> random_tree(std::size_t depth, std::size_t variables, std::mt19937& rng)
+{
+    if (depth == 0 || rng() % 5 == 0)
+    {
+        std::unique_ptr<expression> ident =
+            make_identifier(fmt::format("v{}", rng() % variables));
+        if (rng() % 2 == 0)
+            ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+        return ident;
+    }
+
+    const auto op = rng() % 2 == 0 ? binary_kind::AND : binary_kind::OR;
+    std::unique_ptr<expression> node = make_binary(
+        op, random_tree(depth - 1, variables, rng), random_tree(depth - 1, variables, rng));
+    if (rng() % 4 == 0)
+        node = make_unary(expression_unary::kind::NOT, std::move(node));
+    return node;
+}
+
+/**
+ * Builds the pairs function under the worst order and sifts it
+ */
+void run_pairs(std::size_t n)
+{
+    bdd_manager manager;
+    for (std::size_t i = 0; i < n; i++)
+        (void)manager.variable_of(symbol_table::instance().intern(fmt::format("a{}", i)));
+
+    const auto expr = pairs(n);
+    std::unique_ptr<bdd> f;
+    const auto build_s = time([&] { f = std::make_unique<bdd>(manager.from_expression(*expr)); });
+    const auto before = manager.count_nodes(*f);
+    const auto reorder_s = time([&] { manager.reorder(); });
+
+    std::cout << fmt::format(
+        "pairs {:>3}  build {:.3f} s  {:>7} nodes  sift {:.3f} s  {:>4} nodes\n",
+        n,
+        build_s,
+        before,
+        reorder_s,
+        manager.count_nodes(*f));
+}
+
+/**
+ * Builds the diagrams of `count' random expressions over `variables'
+ * variables in one manager, and sifts them
+ */
+void run_random(std::size_t count, std::size_t variables, std::size_t depth)
+{
+    std::mt19937 rng(42);
+    std::vector<std::unique_ptr<expression>> exprs;
+    for (std::size_t i = 0; i < count; i++)
+        exprs.push_back(random_tree(depth, variables, rng));
+
+    bdd_manager manager;
+    std::vector<bdd> diagrams;
+    const auto build_s = time([&] {
+        for (const auto& expr : exprs)
+            diagrams.push_back(manager.from_expression(*expr));
+    });
+    const auto before = manager.size();
+    const auto reorder_s = time([&] { manager.reorder(); });
+
+    std::cout << fmt::format(
+        "random {:>4} exprs {:>3} vars  build {:.3f} s  {:>7} nodes  sift {:.3f} s  {:>7} nodes\n",
+        count,
+        manager.variables(),
+        build_s,
+        before,
+        reorder_s,
+        manager.size());
+}
+} // namespace
+
+int main()
+{
+    for (const std::size_t n : {8, 12, 16})
+        run_pairs(n);
+
+    run_random(20, 300, 7);
+    run_random(200, 300, 5);
+}
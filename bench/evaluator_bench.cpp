@@ -0,0 +1,144 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "evaluator.hpp"
+#include "expression.hpp"
+
+namespace
+{
+using binary_kind = expression_binary::kind;
+
+/**
+ * Builds a balanced tree over `terms' random literals of `variables'
+ * variables, with random NOTs on the inner nodes
+ */
+std::unique_ptr<expression> balanced(std::size_t terms, std::size_t variables, std::mt19937& rng)
+{
+    std::vector<std::unique_ptr<expression>> level;
+    for (std::size_t i = 0; i < terms; i++)
+    {
+        std::unique_ptr<expression> ident =
+            make_identifier(fmt::format("x{}", i < variables ? i : rng() % variables));
+        if (rng() % 2 == 0)
+            ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+        level.push_back(std::move(ident));
+    }
+
+    while (level.size() > 1)
+    {
+        std::vector<std::unique_ptr<expression>> next;
+        for (std::size_t i = 0; i + 1 < level.size(); i += 2)
+        {
+            const auto op = rng() % 2 == 0 ? binary_kind::AND : binary_kind::OR;
+            std::unique_ptr<expression> node =
+                make_binary(op, std::move(level[i]), std::move(level[i + 1]));
+            if (rng() % 3 == 0)
+                node = make_unary(expression_unary::kind::NOT, std::move(node));
+            next.push_back(std::move(node));
+        }
+        if (level.size() % 2 != 0)
+            next.push_back(std::move(level.back()));
+        level = std::move(next);
+    }
+
+    return std::move(level.front());
+}
+
+// The value of `expr' under the assignment `values' of the variables of
+// `eval', walking the tree once per assignment
+bool walk(const expression& expr, const evaluator& eval, const std::vector<bool>& values)
+{
+    switch (expr.type())
+    {
+    case expression::type::IDENTIFIER:
+    {
+        const auto sym = dynamic_cast<const expression_identifier&>(expr).symbol();
+        const auto& vars = eval.variables();
+        for (std::size_t v = 0; v < vars.size(); v++)
+            if (vars[v] == sym)
+                return values[v];
+        return false;
+    }
+
+    case expression::type::UNARY:
+        return !walk(dynamic_cast<const expression_unary&>(expr).inner(), eval, values);
+
+    case expression::type::BINARY:
+    {
+        const auto& binary = dynamic_cast<const expression_binary&>(expr);
+        const bool is_and = binary.op() == binary_kind::AND;
+        for (const auto& operand : binary.operands())
+            if (walk(*operand, eval, values) != is_and)
+                return !is_and;
+        return is_and;
+    }
+    }
+
+    return false;
+}
+
+template<typename F>
+double time(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Computes the truth table of a random expression, compiled and by
+ * walking the tree for a sample of `samples' assignments
+ */
+void run(std::size_t variables, std::size_t terms, std::size_t samples)
+{
+    std::mt19937 rng(42);
+    const auto expr = balanced(terms, variables, rng);
+
+    std::unique_ptr<evaluator> eval;
+    const auto compile_s = time([&] { eval = std::make_unique<evaluator>(*expr); });
+
+    std::vector<evaluator::word> table;
+    const auto table_s = time([&] { table = eval->truth_table(); });
+
+    std::size_t mismatches = 0;
+    std::vector<bool> values(variables);
+    const auto walk_s = time([&] {
+        for (std::size_t i = 0; i < samples; i++)
+        {
+            const auto assignment = (i * 2654435761U) & ((std::size_t(1) << variables) - 1);
+            for (std::size_t v = 0; v < variables; v++)
+                values[v] = ((assignment >> v) & 1) != 0;
+            const bool expected = ((table[assignment / 64] >> (assignment % 64)) & 1) != 0;
+            mismatches += walk(*expr, *eval, values) != expected;
+        }
+    });
+
+    if (mismatches != 0)
+        std::cerr << fmt::format("{} variables: {} mismatches\n", variables, mismatches);
+
+    const double assignments = static_cast<double>(std::size_t(1) << variables);
+    std::cout << fmt::format(
+        "{:>2} variables {:>6} terms  compile {:.4f} s  table {:.3f} s ({:.0f} M/s)  "
+        "tree walk {:.2f} M/s\n",
+        variables,
+        terms,
+        compile_s,
+        table_s,
+        assignments / table_s / 1e6,
+        static_cast<double>(samples) / walk_s / 1e6);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const auto terms = argc > 1 ? std::stoul(argv[1]) : 200UL;
+    const auto samples = argc > 2 ? std::stoul(argv[2]) : 100'000UL;
+
+    for (const std::size_t variables : {8, 16, 20, 24})
+        run(variables, terms, samples);
+}
@@ -0,0 +1,341 @@
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "lexer_table.hpp"
+
+namespace legacy
+{
+// The transition table `lexer' used before it was compressed, with the
+// enumerations at their original size, kept for comparison
+enum class table_state
+{
+    REJECT,
+    ACCEPT,
+    CONTINUE,
+};
+
+enum class accept_state
+{
+    NONE,
+    IDENTIFIER,
+    OPERATOR,
+    WHITESPACE,
+};
+
+struct state
+{
+    table_state tbl;
+    accept_state acc;
+};
+
+constexpr std::size_t cpow(std::size_t base, std::size_t exp)
+{
+    if (exp == 1)
+        return base;
+    else
+        return base * cpow(base, exp - 1);
+}
+
+constexpr auto LEN = cpow(2, CHAR_BIT);
+using table = std::array<std::array<state, LEN>, LEN>;
+
+constexpr auto END = static_cast<unsigned char>(EOF);
+
+constexpr std::string_view ALPHANUM_START = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+constexpr std::string_view ALPHANUM_REST
+    = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
+constexpr std::string_view WHITESPACE_CHARS = " \t\v\r\n";
+
+constexpr void init_alphanum(table& tbl)
+{
+    for (const auto& s : ALPHANUM_START)
+        tbl['\0'][s] = {table_state::CONTINUE, accept_state::NONE};
+
+    for (const auto& s : ALPHANUM_START)
+        for (const auto& r : ALPHANUM_REST)
+            tbl[s][r] = {table_state::CONTINUE, accept_state::NONE};
+    for (const auto& r1 : ALPHANUM_REST)
+        for (const auto& r2 : ALPHANUM_REST)
+            tbl[r1][r2] = {table_state::CONTINUE, accept_state::NONE};
+    for (const auto& r : ALPHANUM_REST)
+    {
+        for (const auto& w : WHITESPACE_CHARS)
+            tbl[r][w] = {table_state::ACCEPT, accept_state::IDENTIFIER};
+
+        tbl[r]['&'] = {table_state::ACCEPT, accept_state::IDENTIFIER};
+        tbl[r]['|'] = {table_state::ACCEPT, accept_state::IDENTIFIER};
+        tbl[r]['('] = {table_state::ACCEPT, accept_state::IDENTIFIER};
+        tbl[r][')'] = {table_state::ACCEPT, accept_state::IDENTIFIER};
+        tbl[r]['!'] = {table_state::ACCEPT, accept_state::IDENTIFIER};
+
+        tbl[r][END] = {table_state::ACCEPT, accept_state::IDENTIFIER};
+    }
+}
+
+constexpr void init_lparen(table& tbl)
+{
+    tbl['\0']['('] = {table_state::CONTINUE, accept_state::NONE};
+
+    for (const auto& r : ALPHANUM_START)
+        tbl['('][r] = {table_state::ACCEPT, accept_state::OPERATOR};
+    for (const auto& w : WHITESPACE_CHARS)
+        tbl['('][w] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['(']['&'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['(']['|'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['(']['('] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['('][')'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['(']['!'] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['('][END] = {table_state::ACCEPT, accept_state::OPERATOR};
+}
+
+constexpr void init_rparen(table& tbl)
+{
+    tbl['\0'][')'] = {table_state::CONTINUE, accept_state::NONE};
+
+    for (const auto& r : ALPHANUM_START)
+        tbl[')'][r] = {table_state::ACCEPT, accept_state::OPERATOR};
+    for (const auto& w : WHITESPACE_CHARS)
+        tbl[')'][w] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl[')']['&'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl[')']['|'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl[')']['('] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl[')'][')'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl[')']['!'] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl[')'][END] = {table_state::ACCEPT, accept_state::OPERATOR};
+}
+
+constexpr void init_amper(table& tbl)
+{
+    tbl['\0']['&'] = {table_state::CONTINUE, accept_state::NONE};
+
+    for (const auto& r : ALPHANUM_START)
+        tbl['&'][r] = {table_state::ACCEPT, accept_state::OPERATOR};
+    for (const auto& w : WHITESPACE_CHARS)
+        tbl['&'][w] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['&']['&'] = {table_state::CONTINUE, accept_state::NONE};
+    tbl['&']['|'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['&']['('] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['&'][')'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['&']['!'] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['&'][END] = {table_state::ACCEPT, accept_state::OPERATOR};
+}
+
+constexpr void init_bar(table& tbl)
+{
+    tbl['\0']['|'] = {table_state::CONTINUE, accept_state::NONE};
+
+    for (const auto& r : ALPHANUM_START)
+        tbl['|'][r] = {table_state::ACCEPT, accept_state::OPERATOR};
+    for (const auto& w : WHITESPACE_CHARS)
+        tbl['|'][w] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['|']['&'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['|']['|'] = {table_state::CONTINUE, accept_state::NONE};
+    tbl['|']['('] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['|'][')'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['|']['!'] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['|'][END] = {table_state::ACCEPT, accept_state::OPERATOR};
+}
+
+constexpr void init_exclam(table& tbl)
+{
+    tbl['\0']['!'] = {table_state::CONTINUE, accept_state::NONE};
+
+    for (const auto& r : ALPHANUM_START)
+        tbl['!'][r] = {table_state::ACCEPT, accept_state::OPERATOR};
+    for (const auto& w : WHITESPACE_CHARS)
+        tbl['!'][w] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['!']['&'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['!']['|'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['!']['('] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['!'][')'] = {table_state::ACCEPT, accept_state::OPERATOR};
+    tbl['!']['!'] = {table_state::ACCEPT, accept_state::OPERATOR};
+
+    tbl['!'][END] = {table_state::ACCEPT, accept_state::OPERATOR};
+}
+
+constexpr void init_whitespace(table& tbl)
+{
+    for (const auto& w : WHITESPACE_CHARS)
+        tbl['\0'][w] = {table_state::CONTINUE, accept_state::NONE};
+    for (const auto& w : WHITESPACE_CHARS)
+    {
+        for (const auto& r : ALPHANUM_START)
+            tbl[w][r] = {table_state::ACCEPT, accept_state::WHITESPACE};
+
+        tbl[w]['&'] = {table_state::ACCEPT, accept_state::WHITESPACE};
+        tbl[w]['|'] = {table_state::ACCEPT, accept_state::WHITESPACE};
+        tbl[w]['('] = {table_state::ACCEPT, accept_state::WHITESPACE};
+        tbl[w][')'] = {table_state::ACCEPT, accept_state::WHITESPACE};
+        tbl[w]['!'] = {table_state::ACCEPT, accept_state::WHITESPACE};
+
+        tbl[w][END] = {table_state::ACCEPT, accept_state::WHITESPACE};
+    }
+}
+
+constexpr table create_table()
+{
+    table tbl = {};
+    for (auto& row : tbl)
+        for (auto& col : row)
+            col = {table_state::REJECT, accept_state::NONE};
+
+    init_alphanum(tbl);
+    init_lparen(tbl);
+    init_rparen(tbl);
+    init_amper(tbl);
+    init_bar(tbl);
+    init_exclam(tbl);
+    init_whitespace(tbl);
+
+    return tbl;
+}
+
+constexpr table tbl = create_table();
+} // namespace legacy
+
+namespace
+{
+std::string generate_input(std::size_t size)
+{
+    constexpr std::string_view ops[] = {" && ", " || ", " && !", " || !(", ") && ", ") || "};
+
+    std::mt19937 rng(42);
+    std::string input;
+    input.reserve(size + 64);
+
+    int depth = 0;
+    while (input.size() < size)
+    {
+        input += LETTERS[rng() % LETTERS.size()];
+        for (auto len = rng() % 12; len > 0; len--)
+        {
+            const auto ch = rng() % (LETTERS.size() + DIGITS.size());
+            input += ch < LETTERS.size() ? LETTERS[ch] : DIGITS[ch - LETTERS.size()];
+        }
+
+        const auto& op = ops[rng() % std::size(ops)];
+        if (op.front() == ')' && depth == 0)
+            input += ops[0];
+        else
+            input += op;
+
+        if (op.back() == '(')
+            depth++;
+        if (op.front() == ')' && depth > 0)
+            depth--;
+    }
+    input += 'z';
+    for (; depth > 0; depth--)
+        input += ')';
+    input += '\n';
+
+    return input;
+}
+
+/**
+ * Runs the lexer automaton over `input' the way `lexer::next_token' does,
+ * returning a checksum of the states it went through
+ *
+ * `classify' maps a character to the row/column index of the table, and
+ * `step' looks up the transition between two such indices.
+ */
+template<typename Classify, typename Step>
+std::uint64_t scan(std::string_view input, Classify classify, Step step)
+{
+    std::uint64_t checksum = 0;
+
+    auto prev = classify(input[0]);
+    for (std::size_t i = 1; i < input.size(); i++)
+    {
+        const auto cur = classify(input[i]);
+        const auto [tbl, acc] = step(prev, cur);
+        checksum += static_cast<unsigned>(tbl) * 4 + static_cast<unsigned>(acc);
+        prev = cur;
+    }
+
+    return checksum;
+}
+
+template<typename Classify, typename Step>
+double measure(
+    std::string_view name,
+    std::string_view input,
+    Classify classify,
+    Step step,
+    std::uint64_t& checksum)
+{
+    constexpr int RUNS = 10;
+
+    double best = 0;
+    for (int run = 0; run < RUNS; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        checksum = scan(input, classify, step);
+        const auto end = std::chrono::steady_clock::now();
+
+        const auto seconds = std::chrono::duration<double>(end - start).count();
+        best = std::max(best, input.size() / seconds / (1024 * 1024));
+    }
+
+    std::cout << fmt::format("{:<12} {:>10.1f} MiB/s  (checksum {:x})\n", name, best, checksum);
+    return best;
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const auto size = argc > 1 ? std::stoul(argv[1]) : std::size_t(64) << 20;
+    const auto input = generate_input(size);
+
+    std::cout << fmt::format(
+        "Input: {} MiB, legacy table {} KiB, compressed table {} B + {} B class map\n",
+        input.size() >> 20,
+        sizeof(legacy::tbl) >> 10,
+        sizeof(TRANSITIONS),
+        sizeof(CLASS_MAP));
+
+    std::uint64_t legacy_sum = 0;
+    const auto legacy_speed = measure(
+        "legacy",
+        input,
+        [](char ch) { return static_cast<unsigned char>(ch); },
+        [](unsigned char prev, unsigned char cur) {
+            const auto& st = legacy::tbl[prev][cur];
+            return std::pair(st.tbl, st.acc);
+        },
+        legacy_sum);
+
+    std::uint64_t compressed_sum = 0;
+    const auto compressed_speed = measure(
+        "compressed",
+        input,
+        [](char ch) { return classify(ch); },
+        [](char_class prev, char_class cur) {
+            const auto& st = transition(prev, cur);
+            return std::pair(st.tbl, st.acc);
+        },
+        compressed_sum);
+
+    std::cout << fmt::format("Speedup: {:.2f}x\n", compressed_speed / legacy_speed);
+
+    if (legacy_sum != compressed_sum)
+    {
+        std::cerr << "Tables disagree on the benchmark input\n";
+        return 1;
+    }
+}
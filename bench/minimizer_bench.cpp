@@ -0,0 +1,113 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "expression.hpp"
+#include "minimizer.hpp"
+#include "simplifier.hpp"
+
+namespace
+{
+using binary_kind = expression_binary::kind;
+
+template<typename F>
+double time(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::size_t leaf_count(const expression& expr)
+{
+    switch (expr.type())
+    {
+    case expression::type::IDENTIFIER:
+        return 1;
+
+    case expression::type::UNARY:
+        return leaf_count(dynamic_cast<const expression_unary&>(expr).inner());
+
+    case expression::type::BINARY:
+    {
+        std::size_t count = 0;
+        for (const auto& operand : dynamic_cast<const expression_binary&>(expr).operands())
+            count += leaf_count(*operand);
+        return count;
+    }
+    }
+
+    return 0;
+}
+
+/**
+ * Builds a rule table: an OR of `rules' ANDs of `width' literals over
+ * `variables' variables, in which every rule is split into the two
+ * rules that differ in one more variable, as generated tables often are
+ */
+std::unique_ptr<expression>
+rule_table(std::size_t rules, std::size_t width, std::size_t variables, std::mt19937& rng)
+{
+    const auto literal = [&](std::size_t var, bool negated) {
+        std::unique_ptr<expression> ident = make_identifier(fmt::format("v{}", var));
+        if (negated)
+            ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+        return ident;
+    };
+
+    expression_binary::operand_list terms;
+    for (std::size_t r = 0; r < rules; r++)
+    {
+        std::vector<std::pair<std::size_t, bool>> rule;
+        for (std::size_t i = 0; i < width; i++)
+            rule.emplace_back(rng() % variables, rng() % 2 == 0);
+        const auto split = rng() % variables;
+
+        for (const bool negated : {false, true})
+        {
+            expression_binary::operand_list factors;
+            for (const auto& [var, neg] : rule)
+                factors.push_back(literal(var, neg));
+            factors.push_back(literal(split, negated));
+            terms.push_back(make_binary(binary_kind::AND, std::move(factors)));
+        }
+    }
+    return make_binary(binary_kind::OR, std::move(terms));
+}
+
+void run(std::size_t rules, std::size_t width, std::size_t variables)
+{
+    std::mt19937 rng(42);
+    const auto expr = rule_table(rules, width, variables, rng);
+
+    std::unique_ptr<expression> algebraic;
+    std::unique_ptr<expression> minimized;
+    const auto algebraic_s =
+        time([&] { algebraic = simplify(*expr, simplify_level::ALGEBRAIC); });
+    const auto minimize_s = time([&] { minimized = minimize(*expr); });
+
+    std::cout << fmt::format(
+        "{:>4} rules {} literals {:>3} vars  {:>6} leaves  algebraic {:>6} in {:.4f} s  "
+        "minimized {:>6} in {:.4f} s\n",
+        rules,
+        width,
+        variables,
+        leaf_count(*expr),
+        leaf_count(*algebraic),
+        algebraic_s,
+        minimized == nullptr ? 0 : leaf_count(*minimized),
+        minimize_s);
+}
+} // namespace
+
+int main()
+{
+    run(16, 3, 8);
+    run(64, 4, 16);
+    run(256, 5, 32);
+    run(512, 6, 48);
+}
@@ -0,0 +1,81 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "input_source.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+
+namespace
+{
+std::string chain(std::size_t terms)
+{
+    std::string input = "a";
+    for (std::size_t i = 1; i < terms; i++)
+        input += i % 3 == 0 ? " || a" : " && !a";
+    input += '\n';
+    return input;
+}
+
+std::string nested(std::size_t depth)
+{
+    std::string input;
+    for (std::size_t i = 0; i < depth; i++)
+        input += i % 2 == 0 ? "!(" : "(";
+    input += "a";
+    for (std::size_t i = 0; i < depth; i++)
+        input += ")";
+    input += '\n';
+    return input;
+}
+
+std::string left_nested(std::size_t depth)
+{
+    std::string input(depth, '(');
+    input += "a";
+    for (std::size_t i = 0; i < depth; i++)
+        input += " && b)";
+    input += '\n';
+    return input;
+}
+
+void run(std::string_view name, const std::string& input, std::size_t terms)
+{
+    input_string source(input);
+    lexer lex(source);
+    parser par(lex);
+
+    const auto start = std::chrono::steady_clock::now();
+    auto expr = par.parse_expression();
+    const auto parsed = std::chrono::steady_clock::now();
+    expr.reset();
+    const auto destroyed = std::chrono::steady_clock::now();
+
+    const auto parse_s = std::chrono::duration<double>(parsed - start).count();
+    const auto destroy_s = std::chrono::duration<double>(destroyed - parsed).count();
+
+    std::cout << fmt::format(
+        "{:<12} {:>9} terms {:>8.1f} MiB  parse {:>7.3f} s ({:>6.1f} Mterms/s, {:>6.1f} MiB/s)"
+        "  destroy {:.3f} s\n",
+        name,
+        terms,
+        input.size() / (1024.0 * 1024.0),
+        parse_s,
+        terms / parse_s / 1e6,
+        input.size() / parse_s / (1024 * 1024),
+        destroy_s);
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    const auto terms = argc > 1 ? std::stoul(argv[1]) : 4'000'000UL;
+    const auto depth = argc > 2 ? std::stoul(argv[2]) : 1'000'000UL;
+
+    run("chain", chain(terms), terms);
+    run("nested", nested(depth), 1);
+    run("left-nested", left_nested(depth), depth + 1);
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "expression.hpp"
+
+namespace
+{
+using binary_kind = expression_binary::kind;
+
+template<typename F>
+double time(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+std::unique_ptr<expression> literal(std::size_t var, bool negated)
+{
+    std::unique_ptr<expression> ident = make_identifier(fmt::format("v{}", var));
+    if (negated)
+        ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+    return ident;
+}
+
+/**
+ * Builds v0 OR (v1 AND (v2 OR ...)), which alternates its operators so
+ * that no level is flattened into its parent and the tree is `depth'
+ * levels deep
+ */
+std::unique_ptr<expression> chain(std::size_t depth)
+{
+    auto expr = literal(depth, false);
+    for (std::size_t i = depth; i-- > 0;)
+    {
+        const auto op = i % 2 == 0 ? binary_kind::OR : binary_kind::AND;
+        expr = make_binary(op, literal(i, i % 3 == 0), std::move(expr));
+    }
+    return expr;
+}
+
+std::unique_ptr<expression> random_tree(std::size_t depth, std::size_t variables, std::mt19937& rng)
+{
+    if (depth == 0 || rng() % 16 == 0)
+        return literal(rng() % variables, rng() % 2 == 0);
+
+    const auto op = rng() % 2 == 0 ? binary_kind::AND : binary_kind::OR;
+    std::unique_ptr<expression> node = make_binary(
+        op, random_tree(depth - 1, variables, rng), random_tree(depth - 1, variables, rng));
+    if (rng() % 4 == 0)
+        node = make_unary(expression_unary::kind::NOT, std::move(node));
+    return node;
+}
+
+void run(const std::string& name, const expression& expr)
+{
+    std::size_t infix_size = 0;
+    std::size_t debug_size = 0;
+    const auto infix_s = time([&] { infix_size = fmt::format("{}", expr).size(); });
+    const auto debug_s = time([&] { debug_size = fmt::format("{:d}", expr).size(); });
+
+    std::cout << fmt::format(
+        "{:<14} infix {:>9} bytes in {:.4f} s  debug {:>11} bytes in {:.4f} s\n",
+        name,
+        infix_size,
+        infix_s,
+        debug_size,
+        debug_s);
+}
+} // namespace
+
+int main()
+{
+    for (const std::size_t depth : {800, 4000, 8000})
+        run(fmt::format("chain {}", depth), *chain(depth));
+
+    std::mt19937 rng(42);
+    for (const std::size_t depth : {14, 18, 22})
+        run(fmt::format("random {}", depth), *random_tree(depth, 1000, rng));
+}
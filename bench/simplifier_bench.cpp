@@ -0,0 +1,324 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "expression.hpp"
+#include "simplifier.hpp"
+#include "task_pool.hpp"
+
+namespace legacy
+{
+// The recursive simplifier that `simplify' replaced, kept for comparison.
+// It is left as it was written, `dynamic_cast's included, rather than moved
+// to `visit', so that it keeps measuring the original code.
+
+std::unique_ptr<expression> simplify(const expression& expr);
+
+// The right-nested chain of the operands of `binary' from `first' on
+std::unique_ptr<expression> chain(const expression_binary& binary, std::size_t first)
+{
+    const auto& operands = binary.operands();
+    if (first + 1 == operands.size())
+        return operands[first]->clone();
+
+    expression_binary::operand_list rest;
+    for (auto i = first; i < operands.size(); i++)
+        rest.push_back(operands[i]->clone());
+    return make_binary(binary.op(), std::move(rest));
+}
+
+std::unique_ptr<expression> simplify(const expression_unary& unary)
+{
+    auto simp_inner = legacy::simplify(unary.inner());
+
+    switch (simp_inner->type())
+    {
+    case expression::type::UNARY:
+        return dynamic_cast<const expression_unary&>(*simp_inner).inner().clone();
+
+    case expression::type::BINARY:
+    {
+        const auto& simp_binary = dynamic_cast<const expression_binary&>(*simp_inner);
+
+        const auto neg_left =
+            make_unary(expression_unary::kind::NOT, simp_binary.operands().front()->clone());
+        const auto neg_right = make_unary(expression_unary::kind::NOT, chain(simp_binary, 1));
+
+        auto simp_left = legacy::simplify(*neg_left);
+        auto simp_right = legacy::simplify(*neg_right);
+
+        switch (simp_binary.op())
+        {
+        case expression_binary::kind::AND:
+            return make_binary(
+                expression_binary::kind::OR, std::move(simp_left), std::move(simp_right));
+
+        case expression_binary::kind::OR:
+            return make_binary(
+                expression_binary::kind::AND, std::move(simp_left), std::move(simp_right));
+        }
+        break;
+    }
+
+    case expression::type::IDENTIFIER:
+        return make_unary(expression_unary::kind::NOT, std::move(simp_inner));
+    }
+
+    return nullptr;
+}
+
+std::unique_ptr<expression> simplify(const expression_binary& binary, std::size_t first)
+{
+    const auto& operands = binary.operands();
+
+    auto simp_left = legacy::simplify(*operands[first]);
+    auto simp_right = first + 2 == operands.size() ? legacy::simplify(*operands[first + 1])
+                                                   : legacy::simplify(binary, first + 1);
+
+    if (*simp_left == *simp_right)
+        return simp_left;
+
+    return make_binary(binary.op(), std::move(simp_left), std::move(simp_right));
+}
+
+std::unique_ptr<expression> simplify(const expression& expr)
+{
+    switch (expr.type())
+    {
+    case expression::type::IDENTIFIER:
+        return expr.clone();
+
+    case expression::type::BINARY:
+        return legacy::simplify(dynamic_cast<const expression_binary&>(expr), 0);
+
+    case expression::type::UNARY:
+        return legacy::simplify(dynamic_cast<const expression_unary&>(expr));
+    }
+
+    return nullptr;
+}
+} // namespace legacy
+
+namespace
+{
+using binary_kind = expression_binary::kind;
+
+std::unique_ptr<expression> leaf(std::mt19937& rng)
+{
+    constexpr std::string_view names[] = {"a", "b", "c", "d", "e", "f", "g", "h"};
+    std::unique_ptr<expression> ident = make_identifier(names[rng() % std::size(names)]);
+    if (rng() % 2 == 0)
+        ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+    return ident;
+}
+
+std::unique_ptr<expression> negate(std::unique_ptr<expression> expr, std::mt19937& rng)
+{
+    if (rng() % 3 == 0)
+        expr = make_unary(expression_unary::kind::NOT, std::move(expr));
+    return expr;
+}
+
+/**
+ * Builds a balanced tree over `terms' random literals, with random NOTs
+ * on the inner nodes
+ */
+std::unique_ptr<expression> balanced(std::size_t terms, std::mt19937& rng)
+{
+    std::vector<std::unique_ptr<expression>> level;
+    for (std::size_t i = 0; i < terms; i++)
+        level.push_back(leaf(rng));
+
+    while (level.size() > 1)
+    {
+        std::vector<std::unique_ptr<expression>> next;
+        for (std::size_t i = 0; i + 1 < level.size(); i += 2)
+        {
+            const auto op = rng() % 2 == 0 ? binary_kind::AND : binary_kind::OR;
+            next.push_back(
+                negate(make_binary(op, std::move(level[i]), std::move(level[i + 1])), rng));
+        }
+        if (level.size() % 2 != 0)
+            next.push_back(std::move(level.back()));
+        level = std::move(next);
+    }
+
+    return std::move(level.front());
+}
+
+/**
+ * Builds a chain of `terms' random literals, nested to the right as the
+ * parser does, or to the left
+ */
+std::unique_ptr<expression> chain(std::size_t terms, bool right, std::mt19937& rng)
+{
+    auto expr = leaf(rng);
+    for (std::size_t i = 1; i < terms; i++)
+    {
+        const auto op = rng() % 2 == 0 ? binary_kind::AND : binary_kind::OR;
+        expr = right ? make_binary(op, leaf(rng), std::move(expr))
+                     : make_binary(op, std::move(expr), leaf(rng));
+        expr = negate(std::move(expr), rng);
+    }
+    return expr;
+}
+
+template<typename F>
+double time(F&& f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    f();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+template<typename Build>
+void run(std::string_view name, std::size_t terms, bool recursive, Build&& build)
+{
+    // Trees this deep cannot be copied with `clone', so every variant gets
+    // its own input built from the same seed
+    const auto expr = build();
+
+    std::unique_ptr<expression> iterative_result;
+    const auto iterative_s = time([&] { iterative_result = simplify(*expr); });
+
+    auto consumed = build();
+    std::unique_ptr<expression> consuming_result;
+    const auto consuming_s = time([&] { consuming_result = simplify(std::move(consumed)); });
+
+    if (*consuming_result != *iterative_result)
+        std::cerr << fmt::format("{}: consuming and iterative results differ\n", name);
+
+    std::string recursive_time = "skipped";
+    if (recursive)
+    {
+        std::unique_ptr<expression> recursive_result;
+        const auto recursive_s = time([&] { recursive_result = legacy::simplify(*expr); });
+        recursive_time = fmt::format("{:.3f} s", recursive_s);
+
+        if (*recursive_result != *iterative_result)
+            std::cerr << fmt::format("{}: recursive and iterative results differ\n", name);
+    }
+
+    std::cout << fmt::format(
+        "{:<12} {:>9} terms  recursive {:>9}  iterative {:.3f} s  consuming {:.3f} s\n",
+        name,
+        terms,
+        recursive_time,
+        iterative_s,
+        consuming_s);
+}
+/**
+ * Simplifies a stream of `count' expressions drawn from `distinct' random
+ * ones, with and without a `simplify_cache'
+ */
+void run_cached(std::string_view name, std::size_t distinct, std::size_t count, std::size_t terms)
+{
+    std::mt19937 rng(42);
+
+    std::vector<std::unique_ptr<expression>> pool;
+    for (std::size_t i = 0; i < distinct; i++)
+        pool.push_back(balanced(terms, rng));
+
+    std::vector<const expression*> stream;
+    for (std::size_t i = 0; i < count; i++)
+        stream.push_back(pool[rng() % pool.size()].get());
+
+    const auto uncached_s = time([&] {
+        for (const auto* expr : stream)
+            (void)simplify(*expr);
+    });
+
+    simplify_cache cache;
+    const auto cached_s = time([&] {
+        for (const auto* expr : stream)
+            (void)simplify(*expr, cache);
+    });
+
+    std::cout << fmt::format(
+        "{:<12} {:>9} exprs  uncached {:.3f} s  cached {:.3f} s  ({} hits, {} misses)\n",
+        name,
+        count,
+        uncached_s,
+        cached_s,
+        cache.hits(),
+        cache.misses());
+}
+
+/**
+ * Simplifies one expression on pools of 1, 2, 4... workers up to the
+ * number of cores, reporting the speedup over the sequential `simplify'
+ */
+template<typename Build>
+void run_parallel(std::string_view name, std::size_t terms, Build&& build)
+{
+    const auto expr = build();
+
+    std::unique_ptr<expression> serial_result;
+    const auto serial_s = time([&] { serial_result = simplify(*expr); });
+    std::cout << fmt::format("{:<12} {:>9} terms  sequential {:.3f} s\n", name, terms, serial_s);
+
+    const auto cores = task_pool::default_workers();
+    for (std::size_t workers = 1;; workers = std::min(2 * workers, cores))
+    {
+        task_pool pool(workers);
+        std::unique_ptr<expression> parallel_result;
+        const auto parallel_s = time([&] { parallel_result = simplify(*expr, pool); });
+
+        if (*parallel_result != *serial_result)
+            std::cerr << fmt::format("{}: parallel and sequential results differ\n", name);
+
+        std::cout << fmt::format(
+            "{:<12} {:>9} terms  {:>3} workers {:.3f} s  speedup {:.2f}\n",
+            name,
+            terms,
+            workers,
+            parallel_s,
+            serial_s / parallel_s);
+
+        if (workers == cores)
+            break;
+    }
+}
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // The recursive simplifier re-simplifies the operands of every NOT it
+    // pushes down, which is cubic on NOT-heavy chains, so it is only run on
+    // chains up to `max_recursive_terms' long
+    const auto terms = argc > 1 ? std::stoul(argv[1]) : 1'000'000UL;
+    const auto max_recursive_terms = argc > 2 ? std::stoul(argv[2]) : 300UL;
+
+    const auto seeded = [](auto build) {
+        return [build] {
+            std::mt19937 rng(42);
+            return build(rng);
+        };
+    };
+
+    run("balanced", terms, true, seeded([&](auto& rng) { return balanced(terms, rng); }));
+    run("right-chain",
+        terms,
+        terms <= max_recursive_terms,
+        seeded([&](auto& rng) { return chain(terms, true, rng); }));
+    run("left-chain",
+        terms,
+        terms <= max_recursive_terms,
+        seeded([&](auto& rng) { return chain(terms, false, rng); }));
+    run("short-chain",
+        max_recursive_terms,
+        true,
+        seeded([&](auto& rng) { return chain(max_recursive_terms, true, rng); }));
+
+    run_parallel("par-balanced", terms, seeded([&](auto& rng) { return balanced(terms, rng); }));
+    run_parallel("par-chain", terms, seeded([&](auto& rng) { return chain(terms, true, rng); }));
+
+    run_cached("repeated", 300, 20'000, 64);
+    run_cached("unique", 20'000, 20'000, 64);
+}
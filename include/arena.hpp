@@ -0,0 +1,81 @@
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+#include <cstddef>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+// Freed nodes of up to `SIZE_CLASSES' times `ALIGNMENT' bytes are reused
+// through a free list per size, larger ones through a single list searched
+// for the exact size. Nothing goes back to the system before `release'.
+// The operand vectors of n-ary nodes come from the global heap, not from
+// the arena, so wide nodes use memory that `bytes_reserved' does not count.
+class expression_arena final
+{
+public:
+    explicit expression_arena(std::size_t block_size = DEFAULT_BLOCK_SIZE);
+    expression_arena(const expression_arena&) = delete;
+    expression_arena(expression_arena&&) = delete;
+    ~expression_arena() = default;
+
+    expression_arena& operator=(const expression_arena&) = delete;
+    expression_arena& operator=(expression_arena&&) = delete;
+
+    [[nodiscard]] void* allocate(std::size_t size);
+    void deallocate(void* ptr, std::size_t size) noexcept;
+    void release() noexcept;
+
+    [[nodiscard]] std::size_t bytes_reserved() const noexcept;
+    [[nodiscard]] std::size_t bytes_in_use() const noexcept;
+
+    [[nodiscard]] static expression_arena* current() noexcept;
+
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+    static constexpr std::size_t ALIGNMENT = alignof(std::max_align_t);
+
+private:
+    static constexpr std::size_t SIZE_CLASSES = 16;
+
+    struct free_node
+    {
+        free_node* next;
+    };
+
+    struct oversize_node
+    {
+        oversize_node* next;
+        std::size_t size;
+    };
+
+    std::size_t block_size_;
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::vector<std::unique_ptr<std::byte[]>> large_blocks_;
+    std::size_t large_bytes_;
+    std::byte* cursor_;
+    std::byte* end_;
+    std::array<free_node*, SIZE_CLASSES> free_lists_;
+    oversize_node* oversize_;
+    std::size_t bytes_in_use_;
+
+    static std::size_t size_class(std::size_t size) noexcept;
+};
+
+class arena_scope final
+{
+public:
+    explicit arena_scope(expression_arena* arena) noexcept;
+    explicit arena_scope(expression_arena& arena) noexcept;
+    arena_scope(const arena_scope&) = delete;
+    arena_scope(arena_scope&&) = delete;
+    ~arena_scope();
+
+    arena_scope& operator=(const arena_scope&) = delete;
+    arena_scope& operator=(arena_scope&&) = delete;
+
+private:
+    expression_arena* previous_;
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+#include <cstddef>
+
+#include <iosfwd>
+
+#include "input_source.hpp"
+
+struct batch_result
+{
+    std::size_t expressions;
+    std::size_t errors;
+    std::size_t failures;
+};
+
+constexpr std::size_t BATCH_CHUNK_SIZE = 64 * 1024;
+constexpr std::size_t BATCH_CHUNKS_PER_JOB = 4;
+constexpr std::size_t BATCH_TABLE_LIMIT = std::size_t(1) << 16;
+
+batch_result run_batch(input_source& in, std::ostream& out, bool verify, std::size_t jobs = 1);
+
+#endif
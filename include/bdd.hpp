@@ -0,0 +1,175 @@
+#ifndef BDD_HPP
+#define BDD_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "expression.hpp"
+#include "symbol_table.hpp"
+
+class bdd_manager;
+
+class bdd final
+{
+public:
+    using node_ref = std::uint32_t;
+
+    bdd(bdd_manager& manager, node_ref node) noexcept;
+    bdd(const bdd& src) noexcept;
+    bdd(bdd&& src) noexcept;
+    ~bdd();
+
+    bdd& operator=(const bdd& src) noexcept;
+    bdd& operator=(bdd&& src) noexcept;
+
+    [[nodiscard]] bdd_manager& manager() const noexcept;
+    [[nodiscard]] const node_ref& node() const noexcept;
+
+    [[nodiscard]] bool is_true() const noexcept;
+    [[nodiscard]] bool is_false() const noexcept;
+
+private:
+    bdd_manager* manager_;
+    node_ref node_;
+};
+
+class bdd_manager final
+{
+public:
+    using node_ref = bdd::node_ref;
+    using variable = std::uint32_t;
+
+    explicit bdd_manager(std::size_t cache_size = DEFAULT_CACHE_SIZE);
+    bdd_manager(const bdd_manager&) = delete;
+    bdd_manager(bdd_manager&&) = delete;
+    ~bdd_manager() = default;
+
+    bdd_manager& operator=(const bdd_manager&) = delete;
+    bdd_manager& operator=(bdd_manager&&) = delete;
+
+    [[nodiscard]] bdd constant(bool value);
+    [[nodiscard]] bdd variable_of(symbol_table::symbol sym);
+    [[nodiscard]] bdd ite(const bdd& f, const bdd& g, const bdd& h);
+
+    [[nodiscard]] bdd from_expression(const expression& expr);
+    [[nodiscard]] std::unique_ptr<expression>
+    to_expression(const bdd& f, std::size_t budget = EXPRESSION_BUDGET);
+
+    void reorder();
+    void collect_garbage();
+    void set_auto_reorder(bool enabled) noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::size_t count_nodes(const bdd& f) const;
+    [[nodiscard]] std::size_t variables() const noexcept;
+    [[nodiscard]] const std::vector<variable>& order() const noexcept;
+    [[nodiscard]] symbol_table::symbol symbol(variable var) const;
+
+    static constexpr node_ref FALSE = 0;
+    static constexpr node_ref TRUE = 1;
+
+    static constexpr std::size_t DEFAULT_CACHE_SIZE = std::size_t(1) << 16;
+    static constexpr std::size_t FIRST_REORDER_SIZE = 4096;
+    static constexpr std::size_t EXPRESSION_BUDGET = std::size_t(1) << 16;
+
+private:
+    friend class bdd;
+
+    static constexpr variable TERMINAL = UINT32_MAX;
+    static constexpr variable FREED = UINT32_MAX - 1;
+    static constexpr node_ref NO_NODE = UINT32_MAX;
+
+    static constexpr std::uint32_t NO_CUBES = 0;
+    static constexpr std::uint32_t EMPTY_CUBE = 1;
+
+    struct node
+    {
+        variable var;
+        node_ref low;
+        node_ref high;
+        std::uint32_t refs;
+        node_ref next;
+    };
+
+    // Nodes of one variable, chained through `node::next'
+    struct subtable
+    {
+        std::vector<node_ref> buckets;
+        std::size_t count;
+    };
+
+    struct cache_entry
+    {
+        node_ref f;
+        node_ref g;
+        node_ref h;
+        node_ref result;
+    };
+
+    // Cubes of a sum of products: NOT(`var') times the cubes of `negative',
+    // `var' times those of `positive', and the cubes of `both'
+    struct cube_set
+    {
+        variable var;
+        std::uint32_t negative;
+        std::uint32_t positive;
+        std::uint32_t both;
+    };
+
+    struct isop_result
+    {
+        node_ref function;
+        std::uint32_t cubes;
+    };
+
+    std::vector<node> nodes_;
+    std::vector<node_ref> free_;
+    std::vector<subtable> unique_;
+    std::vector<std::uint32_t> levels_;
+    std::vector<variable> order_;
+    std::vector<symbol_table::symbol> symbols_;
+    std::unordered_map<symbol_table::symbol, variable> variable_index_;
+    std::vector<cache_entry> cache_;
+    std::size_t dead_;
+    bool auto_reorder_;
+    std::size_t next_reorder_;
+
+    [[nodiscard]] variable intern_variable(symbol_table::symbol sym);
+    [[nodiscard]] std::uint32_t level(node_ref f) const noexcept;
+    [[nodiscard]] node_ref make_node(variable var, node_ref low, node_ref high);
+    [[nodiscard]] node_ref ite(node_ref f, node_ref g, node_ref h);
+    [[nodiscard]] node_ref& bucket(variable var, node_ref low, node_ref high) noexcept;
+    void insert_unique(node_ref f);
+    void erase_unique(node_ref f) noexcept;
+    void ref(node_ref f) noexcept;
+    void deref(node_ref f) noexcept;
+    void release(node_ref f);
+    void maintain();
+    void swap_levels(std::uint32_t upper);
+    void sift(variable var);
+    [[nodiscard]] isop_result isop(
+        node_ref lower,
+        node_ref upper,
+        std::vector<cube_set>& sets,
+        std::unordered_map<std::uint64_t, isop_result>& memo);
+    void append_cubes(
+        const std::vector<cube_set>& sets,
+        std::uint32_t set,
+        std::vector<std::pair<variable, bool>>& literals,
+        expression_binary::operand_list& terms) const;
+};
+
+
+bool operator==(const bdd& l, const bdd& r) noexcept;
+bool operator!=(const bdd& l, const bdd& r) noexcept;
+
+bdd bdd_not(const bdd& f);
+bdd bdd_and(const bdd& l, const bdd& r);
+bdd bdd_or(const bdd& l, const bdd& r);
+
+#endif
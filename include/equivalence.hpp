@@ -0,0 +1,45 @@
+#ifndef EQUIVALENCE_HPP
+#define EQUIVALENCE_HPP
+
+#include <cstddef>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "expression.hpp"
+#include "sat_solver.hpp"
+#include "symbol_table.hpp"
+
+enum class equivalence_status
+{
+    EQUIVALENT,
+    DIFFERENT,
+    UNKNOWN,
+};
+
+enum class equivalence_method
+{
+    EXHAUSTIVE,
+    SAMPLING,
+    SAT,
+};
+
+struct equivalence_result
+{
+    equivalence_status status;
+    equivalence_method method;
+    std::vector<std::pair<symbol_table::symbol, bool>> counterexample;
+};
+
+constexpr std::size_t EXHAUSTIVE_VARIABLES = 16;
+constexpr std::size_t SAMPLE_WORDS = 64;
+
+equivalence_result check_equivalence(
+    const expression& left,
+    const expression& right,
+    std::size_t conflict_budget = sat_solver::DEFAULT_CONFLICT_BUDGET);
+std::string verification_message(const equivalence_result& result);
+void report_verification(std::size_t index, const equivalence_result& result);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef EVALUATOR_HPP
+#define EVALUATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+#include "expression.hpp"
+#include "symbol_table.hpp"
+
+class evaluator final
+{
+public:
+    using word = std::uint64_t;
+
+    enum class opcode : std::uint8_t
+    {
+        LOAD,
+        NOT,
+        AND,
+        OR,
+    };
+
+    struct instruction
+    {
+        opcode op;
+        std::uint32_t variable;
+    };
+
+    explicit evaluator(const expression& expr);
+    evaluator(const expression& expr, std::vector<symbol_table::symbol> variables);
+    evaluator(const evaluator&) = default;
+    evaluator(evaluator&&) noexcept = default;
+    ~evaluator() = default;
+
+    evaluator& operator=(const evaluator&) = default;
+    evaluator& operator=(evaluator&&) noexcept = default;
+
+    [[nodiscard]] const std::vector<symbol_table::symbol>& variables() const noexcept;
+    [[nodiscard]] const std::vector<instruction>& program() const noexcept;
+
+    [[nodiscard]] word evaluate(const word* inputs) const;
+    void evaluate(const word* inputs, word* outputs, std::size_t words) const;
+    [[nodiscard]] std::vector<word> truth_table() const;
+    [[nodiscard]] std::vector<word> truth_table(std::size_t variables) const;
+
+    static constexpr std::size_t WORD_BITS = 64;
+    static constexpr std::size_t MAX_TRUTH_TABLE_VARIABLES = 26;
+
+    [[nodiscard]] static word variable_pattern(std::size_t variable, std::size_t index) noexcept;
+
+private:
+    std::vector<symbol_table::symbol> variables_;
+    std::vector<instruction> program_;
+    std::size_t depth_;
+
+    void compile(const expression& expr);
+};
+
+#endif
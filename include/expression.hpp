@@ -2,14 +2,22 @@
 #define EXPRESSION_HPP
 
 #include <cassert>
+#include <cstdint>
 
+#include <algorithm>
 #include <memory>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <variant>
+#include <vector>
 #include <map>
 
 #include <fmt/format.h>
 
+#include "symbol_table.hpp"
+
 class expression
 {
 public:
@@ -27,8 +35,21 @@ public:
     [[nodiscard]] virtual std::unique_ptr<expression> clone() const = 0;
     [[nodiscard]] virtual enum type type() const noexcept = 0;
 
+    [[nodiscard]] const std::uint32_t& id() const noexcept;
+    [[nodiscard]] const std::uint32_t& nodes() const noexcept;
+
+    [[nodiscard]] static void* operator new(std::size_t size);
+    static void operator delete(void* ptr, std::size_t size) noexcept;
+
 protected:
-    explicit expression() noexcept;
+    expression(std::uint32_t id, std::uint32_t nodes) noexcept;
+
+    void set_id(std::uint32_t id) noexcept;
+    void set_nodes(std::uint32_t nodes) noexcept;
+
+private:
+    std::uint32_t id_;
+    std::uint32_t nodes_;
 };
 
 class expression_binary final : public expression
@@ -40,22 +61,31 @@ public:
         OR,
     };
 
+    using operand_list = std::vector<std::unique_ptr<expression>>;
+
+    expression_binary(kind op, operand_list operands);
     expression_binary(kind op, std::unique_ptr<expression> left, std::unique_ptr<expression> right);
     expression_binary(const expression_binary& src);
     expression_binary(expression_binary&&) = default;
-    ~expression_binary() override = default;
+    ~expression_binary() override;
 
     [[nodiscard]] const kind& op() const noexcept;
-    [[nodiscard]] const expression& left() const noexcept;
-    [[nodiscard]] const expression& right() const noexcept;
+    [[nodiscard]] const operand_list& operands() const noexcept;
+
+    [[nodiscard]] operand_list take_operands() noexcept;
+    void assign(kind op, operand_list operands);
 
     [[nodiscard]] std::unique_ptr<expression> clone() const override;
     [[nodiscard]] enum type type() const noexcept override;
 
+    [[nodiscard]] static std::uint32_t
+    fold_id(kind op, std::uint32_t left, std::uint32_t right);
+
 private:
     kind op_;
-    std::unique_ptr<expression> left_;
-    std::unique_ptr<expression> right_;
+    operand_list operands_;
+
+    void normalize();
 };
 
 class expression_unary final : public expression
@@ -69,34 +99,39 @@ public:
     expression_unary(kind op, std::unique_ptr<expression> inner);
     expression_unary(const expression_unary& src);
     expression_unary(expression_unary&&) = default;
-    ~expression_unary() override = default;
+    ~expression_unary() override;
 
     [[nodiscard]] const kind& op() const noexcept;
     [[nodiscard]] const expression& inner() const noexcept;
 
+    [[nodiscard]] std::unique_ptr<expression> take_inner() noexcept;
+    void assign(kind op, std::unique_ptr<expression> inner);
+
     [[nodiscard]] std::unique_ptr<expression> clone() const override;
     [[nodiscard]] enum type type() const noexcept override;
 
 private:
     kind op_;
-    std::unique_ptr<const expression> inner_;
+    std::unique_ptr<expression> inner_;
 };
 
 class expression_identifier final : public expression
 {
 public:
-    explicit expression_identifier(std::string name);
+    explicit expression_identifier(symbol_table::symbol sym);
+    explicit expression_identifier(std::string_view name);
     expression_identifier(const expression_identifier& src);
     expression_identifier(expression_identifier&&) = default;
     ~expression_identifier() override = default;
 
-    [[nodiscard]] const std::string& name() const noexcept;
+    [[nodiscard]] const symbol_table::symbol& symbol() const noexcept;
+    [[nodiscard]] const std::string& name() const;
 
     [[nodiscard]] std::unique_ptr<expression> clone() const override;
     [[nodiscard]] enum type type() const noexcept override;
 
 private:
-    std::string name_;
+    symbol_table::symbol symbol_;
 };
 
 
@@ -114,9 +149,55 @@ std::unique_ptr<expression_binary> make_binary(
     expression_binary::kind kind,
     std::unique_ptr<expression> left,
     std::unique_ptr<expression> right);
+std::unique_ptr<expression_binary>
+make_binary(expression_binary::kind kind, expression_binary::operand_list operands);
 std::unique_ptr<expression_unary>
 make_unary(expression_unary::kind kind, std::unique_ptr<expression> inner);
-std::unique_ptr<expression_identifier> make_identifier(std::string name);
+std::unique_ptr<expression_identifier> make_identifier(symbol_table::symbol sym);
+std::unique_ptr<expression_identifier> make_identifier(std::string_view name);
+
+
+// Calls `visitor' with `expr' cast to the class of its `type()'. The tag
+// switch and `static_cast' replace a chain of `dynamic_cast's, and every
+// call must return the same type.
+template<typename Expression, typename Visitor>
+decltype(auto) visit(Expression& expr, Visitor&& visitor)
+{
+    static_assert(std::is_same_v<std::remove_const_t<Expression>, expression>);
+
+    using binary = std::conditional_t<
+        std::is_const_v<Expression>, const expression_binary, expression_binary>;
+    using unary = std::conditional_t<
+        std::is_const_v<Expression>, const expression_unary, expression_unary>;
+    using identifier = std::conditional_t<
+        std::is_const_v<Expression>, const expression_identifier, expression_identifier>;
+
+    switch (expr.type())
+    {
+    case expression::type::BINARY:
+        return std::forward<Visitor>(visitor)(static_cast<binary&>(expr));
+
+    case expression::type::UNARY:
+        return std::forward<Visitor>(visitor)(static_cast<unary&>(expr));
+
+    case expression::type::IDENTIFIER:
+        break;
+    }
+    return std::forward<Visitor>(visitor)(static_cast<identifier&>(expr));
+}
+
+// Combines lambdas into one visitor, one per class of node
+template<typename... Cases>
+struct overloaded : Cases...
+{
+    using Cases::operator()...;
+};
+
+template<typename... Cases>
+overloaded(Cases...) -> overloaded<Cases...>;
+
+void print_expression(
+    fmt::memory_buffer& out, const expression& expr, bool debug = false, long offset = 0);
 
 
 namespace fmt
@@ -146,36 +227,12 @@ constexpr inline auto parse_fmt(format_parse_context& ctx, bool& debug, long& of
     return it;
 }
 
-inline std::string subformat_debug(long offset, const expression& expr)
-{
-    const auto subf = fmt::format("{{:d{0}}}", offset);
-    return fmt::format(subf, expr);
-}
-
-inline std::string subformat(enum expression::type parent_type, const expression& expr)
+template<typename FormatContext>
+auto print_to(FormatContext& ctx, const expression& expr, bool debug, long offset)
 {
-    const auto subf = ([&]() {
-        switch (parent_type)
-        {
-        case expression::type::IDENTIFIER:
-            assert(!"Identifier doesn't have subexpressions");
-            return std::string();
-
-        case expression::type::UNARY:
-        case expression::type::BINARY:
-            switch (expr.type())
-            {
-            case expression::type::IDENTIFIER:
-            case expression::type::UNARY:
-                return fmt::format("{{}}");
-
-            case expression::type::BINARY:
-                return fmt::format("({{}})");
-            }
-        }
-    })();
-
-    return fmt::format(subf, expr);
+    memory_buffer out;
+    print_expression(out, expr, debug, offset);
+    return std::copy(out.begin(), out.end(), ctx.out());
 }
 
 
@@ -193,43 +250,7 @@ struct formatter<expression_binary>
     template<typename FormatContext>
     auto format(const expression_binary& expr_bin, FormatContext& ctx)
     {
-        if (debug)
-        {
-            const auto op_str = ([&expr_bin]() {
-                switch (expr_bin.op())
-                {
-                case expression_binary::kind::AND:
-                    return "AND";
-
-                case expression_binary::kind::OR:
-                    return "OR";
-                }
-            })();
-
-            std::string offset_str;
-            offset_str.append(offset, ' ');
-
-            const auto left = subformat_debug(offset + 2, expr_bin.left());
-            const auto right = subformat_debug(offset + 2, expr_bin.right());
-            return format_to(ctx.out(), "{0}({1}\n{2}\n{3})", offset_str, op_str, left, right);
-        }
-        else
-        {
-            const auto op_str = ([&expr_bin]() {
-                switch (expr_bin.op())
-                {
-                case expression_binary::kind::AND:
-                    return "&&";
-
-                case expression_binary::kind::OR:
-                    return "||";
-                }
-            })();
-
-            const auto left = subformat(expression::type::BINARY, expr_bin.left());
-            const auto right = subformat(expression::type::BINARY, expr_bin.right());
-            return format_to(ctx.out(),"{0} {1} {2}", left, op_str, right);
-        }
+        return print_to(ctx, expr_bin, debug, offset);
     }
 };
 
@@ -247,39 +268,7 @@ struct formatter<expression_unary>
     template<typename FormatContext>
     auto format(const expression_unary& expr_un, FormatContext& ctx)
     {
-        if (debug)
-        {
-            const auto op_str = ([&expr_un]() {
-                switch (expr_un.op())
-                {
-                case expression_unary::kind::NOT:
-                    return "NOT";
-                }
-            })();
-
-            std::string offset_str;
-            offset_str.append(offset, ' ');
-
-            const auto inner = subformat_debug(offset + 2, expr_un.inner());
-            return format_to(ctx.out(), "{0}({1}\n{2})", offset_str, op_str, inner);
-        }
-        else
-        {
-            const auto op_str = ([&expr_un]() {
-                switch (expr_un.op())
-                {
-                case expression_unary::kind::NOT:
-                    return "!";
-                }
-            })();
-
-            const auto inner = subformat(expression::type::UNARY, expr_un.inner());
-            return format_to(
-                ctx.out(),
-                "{0}{1}",
-                op_str,
-                inner);
-        }
+        return print_to(ctx, expr_un, debug, offset);
     }
 };
 
@@ -297,70 +286,25 @@ struct formatter<expression_identifier>
     template<typename FormatContext>
     auto format(const expression_identifier& expr_ident, FormatContext& ctx)
     {
-        if (debug)
-        {
-            std::string offset_str;
-            offset_str.append(offset, ' ');
-
-            return format_to(ctx.out(), "{}(ID {})", offset_str, expr_ident.name());
-        }
-        else
-        {
-            return format_to(ctx.out(), "{}", expr_ident.name());
-        }
+        return print_to(ctx, expr_ident, debug, offset);
     }
 };
 
 template<>
 struct formatter<expression>
 {
-    std::string_view fmt_string = "";
+    long offset = 0;
+    bool debug = false;
 
     constexpr auto parse(format_parse_context& ctx)
     {
-        size_t len = 0;
-
-        auto it = ctx.begin();
-        auto end = ctx.end();
-
-        while (it != end && *it != '}')
-        {
-            len++;
-            it++;
-        }
-
-        // Check if reached the end of the range:
-        if (it != end && *it != '}')
-            throw format_error("invalid format");
-
-        fmt_string = {ctx.begin(), len};
-
-        // Return an iterator past the end of the parsed range:
-        return it;
+        return parse_fmt(ctx, debug, offset);
     }
 
     template<typename FormatContext>
     auto format(const expression& expr, FormatContext& ctx)
     {
-        const auto subformat = fmt::format("{{:{}}}", fmt_string);
-
-        if (const auto* expr_bin = dynamic_cast<const expression_binary*>(&expr))
-        {
-            return format_to(ctx.out(), subformat, *expr_bin);
-        }
-        else if (const auto* expr_un = dynamic_cast<const expression_unary*>(&expr))
-        {
-            return format_to(ctx.out(), subformat, *expr_un);
-        }
-        else if (const auto* expr_ident = dynamic_cast<const expression_identifier*>(&expr))
-        {
-            return format_to(ctx.out(), subformat, *expr_ident);
-        }
-        else
-        {
-            assert(!"Cannot format an `expression'");
-            return ctx.out();
-        }
+        return print_to(ctx, expr, debug, offset);
     }
 };
 } // namespace fmt
@@ -0,0 +1,63 @@
+#ifndef EXPRESSION_TABLE_HPP
+#define EXPRESSION_TABLE_HPP
+
+#include <cstdint>
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+// Every node constructor interns its structure here, taking the lock of
+// one of `SHARDS' shards. Ids stay valid until `clear', which may only be
+// called when no node is alive.
+class expression_table final
+{
+public:
+    using id = std::uint32_t;
+
+    expression_table(const expression_table&) = delete;
+    expression_table(expression_table&&) = delete;
+    ~expression_table() = default;
+
+    expression_table& operator=(const expression_table&) = delete;
+    expression_table& operator=(expression_table&&) = delete;
+
+    [[nodiscard]] id intern(std::uint32_t tag, id first, id second);
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] std::uint64_t generation() const noexcept;
+    void clear() noexcept;
+
+    [[nodiscard]] static expression_table& instance() noexcept;
+
+private:
+    static constexpr std::size_t SHARDS = 64;
+
+    struct entry
+    {
+        std::uint32_t tag;
+        id first;
+        id second;
+        id value;
+    };
+
+    struct alignas(64) shard
+    {
+        std::mutex mutex;
+        std::vector<entry> slots;
+        std::size_t used = 0;
+    };
+
+    std::array<shard, SHARDS> shards_;
+
+    std::atomic<id> next_id_;
+    std::atomic<std::uint64_t> generation_;
+
+    explicit expression_table() noexcept;
+
+    [[nodiscard]] id next_id();
+    static void grow(shard& sh);
+};
+
+#endif
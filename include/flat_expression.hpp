@@ -0,0 +1,98 @@
+#ifndef FLAT_EXPRESSION_HPP
+#define FLAT_EXPRESSION_HPP
+
+#include <cstdint>
+
+#include <memory>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "expression.hpp"
+#include "symbol_table.hpp"
+
+class flat_expression final
+{
+public:
+    using index = std::uint32_t;
+
+    enum class op : std::uint8_t
+    {
+        IDENTIFIER,
+        NOT,
+        AND,
+        OR,
+    };
+
+    struct node
+    {
+        op tag;
+        index left;
+        index right;
+    };
+
+    flat_expression() = default;
+    flat_expression(const flat_expression&) = default;
+    flat_expression(flat_expression&&) noexcept = default;
+    ~flat_expression() = default;
+
+    flat_expression& operator=(const flat_expression&) = default;
+    flat_expression& operator=(flat_expression&&) noexcept = default;
+
+    [[nodiscard]] const std::vector<node>& nodes() const noexcept;
+    [[nodiscard]] index root() const noexcept;
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] bool empty() const noexcept;
+
+    index push_identifier(symbol_table::symbol sym);
+    index push_unary(index inner);
+    index push_binary(op tag, index left, index right);
+
+    void reserve(std::size_t size);
+    void clear() noexcept;
+
+private:
+    std::vector<node> nodes_;
+};
+
+static_assert(sizeof(flat_expression::node) <= 16);
+
+
+bool operator==(const flat_expression& l, const flat_expression& r);
+bool operator!=(const flat_expression& l, const flat_expression& r);
+
+
+flat_expression flatten(const expression& expr);
+std::unique_ptr<expression> unflatten(const flat_expression& flat);
+
+flat_expression simplify(const flat_expression& flat);
+
+void print_flat(
+    fmt::memory_buffer& out, const flat_expression& flat, bool debug = false, long offset = 0);
+
+
+namespace fmt
+{
+
+template<>
+struct formatter<flat_expression>
+{
+    long offset = 0;
+    bool debug = false;
+
+    constexpr auto parse(format_parse_context& ctx)
+    {
+        return parse_fmt(ctx, debug, offset);
+    }
+
+    template<typename FormatContext>
+    auto format(const flat_expression& flat, FormatContext& ctx)
+    {
+        memory_buffer out;
+        print_flat(out, flat, debug, offset);
+        return std::copy(out.begin(), out.end(), ctx.out());
+    }
+};
+} // namespace fmt
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef INPUT_SOURCE_HPP
+#define INPUT_SOURCE_HPP
+
+#include <cstddef>
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class input_source
+{
+public:
+    input_source(const input_source&) = delete;
+    input_source(input_source&&) = delete;
+    virtual ~input_source() = default;
+
+    input_source& operator=(const input_source&) = delete;
+    input_source& operator=(input_source&&) = delete;
+
+    [[nodiscard]] virtual std::string_view next(std::size_t keep) = 0;
+    [[nodiscard]] virtual bool failed() const noexcept;
+
+protected:
+    explicit input_source() noexcept = default;
+};
+
+class input_string final : public input_source
+{
+public:
+    explicit input_string(std::string_view text) noexcept;
+    ~input_string() override = default;
+
+    [[nodiscard]] std::string_view next(std::size_t keep) override;
+
+private:
+    std::string_view text_;
+    bool consumed_;
+};
+
+class input_mmap final : public input_source
+{
+public:
+    input_mmap(void* data, std::size_t size) noexcept;
+    ~input_mmap() override;
+
+    [[nodiscard]] std::string_view next(std::size_t keep) override;
+
+private:
+    void* data_;
+    std::size_t size_;
+    bool consumed_;
+};
+
+class input_buffered final : public input_source
+{
+public:
+    explicit input_buffered(std::istream& stream, std::size_t block_size = DEFAULT_BLOCK_SIZE);
+    explicit input_buffered(
+        std::unique_ptr<std::istream> stream,
+        std::size_t block_size = DEFAULT_BLOCK_SIZE);
+    ~input_buffered() override;
+
+    [[nodiscard]] std::string_view next(std::size_t keep) override;
+    [[nodiscard]] bool failed() const noexcept override;
+
+    static constexpr std::size_t DEFAULT_BLOCK_SIZE = 1024 * 1024;
+
+private:
+    std::unique_ptr<std::istream> owned_stream_;
+    std::istream& stream_;
+    std::size_t block_size_;
+    std::vector<char> buffer_;
+    std::size_t size_;
+    bool failed_;
+};
+
+class input_fd final : public input_source
+{
+public:
+    input_fd(
+        int fd,
+        std::string name,
+        bool owned,
+        std::size_t block_size = input_buffered::DEFAULT_BLOCK_SIZE);
+    ~input_fd() override;
+
+    [[nodiscard]] std::string_view next(std::size_t keep) override;
+    [[nodiscard]] bool failed() const noexcept override;
+
+private:
+    int fd_;
+    std::string name_;
+    bool owned_;
+    std::size_t block_size_;
+    std::vector<char> buffer_;
+    std::size_t size_;
+    bool failed_;
+};
+
+
+std::unique_ptr<input_source> open_input(const char* path);
+
+#endif
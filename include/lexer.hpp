@@ -1,29 +1,37 @@
 #ifndef LEXER_HPP
 #define LEXER_HPP
 
+#include <cstdint>
+
 #include <iosfwd>
 #include <map>
+#include <memory>
 #include <optional>
+#include <string_view>
 
+#include "input_source.hpp"
 #include "position.hpp"
 #include "token.hpp"
 
 class lexer
 {
 public:
-    enum class table_state
+    enum class table_state : std::uint8_t
     {
         REJECT,
         ACCEPT,
         CONTINUE,
     };
 
-    enum class accept_state
+    // New states go last, since lexer_bench checksums the values of the
+    // states shared with its legacy table
+    enum class accept_state : std::uint8_t
     {
         NONE,
         IDENTIFIER,
         OPERATOR,
         WHITESPACE,
+        SEPARATOR,
     };
 
     struct state
@@ -33,15 +41,28 @@ public:
     };
 
     explicit lexer(std::istream& stream);
+    explicit lexer(input_source& source);
+
+    token next_token();
 
-    std::unique_ptr<token> next_token();
+    void set_newline_separators(bool enabled) noexcept;
+    void set_semicolon_separators(bool enabled) noexcept;
+    void set_diagnostics(bool enabled) noexcept;
 
 private:
-    std::istream& stream_;
+    std::unique_ptr<input_source> owned_source_;
+    input_source& source_;
+    std::string_view buffer_;
+    std::size_t offset_;
+    std::size_t token_start_;
     position current_pos;
+    bool newline_separators_;
+    bool semicolon_separators_;
+    bool diagnostics_;
 
     char prev_char;
 
+    std::optional<token> scan();
     char read();
 };
 
@@ -0,0 +1,148 @@
+#ifndef LEXER_TABLE_HPP
+#define LEXER_TABLE_HPP
+
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+
+#include <array>
+#include <string_view>
+
+#include "lexer.hpp"
+
+enum class char_class : std::uint8_t
+{
+    OTHER,
+    NUL,
+    LETTER,
+    DIGIT,
+    WHITESPACE,
+    AMPER,
+    BAR,
+    LPAREN,
+    RPAREN,
+    EXCLAM,
+    SEMICOLON,
+    END,
+};
+
+constexpr std::size_t CHAR_CLASSES = static_cast<std::size_t>(char_class::END) + 1;
+constexpr std::size_t CHARS = std::size_t(1) << CHAR_BIT;
+
+using class_map = std::array<char_class, CHARS>;
+using transition_table = std::array<std::array<lexer::state, CHAR_CLASSES>, CHAR_CLASSES>;
+
+constexpr std::string_view LETTERS = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
+constexpr std::string_view DIGITS = "0123456789";
+constexpr std::string_view WHITESPACE = " \t\v\r\n";
+
+constexpr class_map create_class_map()
+{
+    class_map map = {};
+    for (auto& cls : map)
+        cls = char_class::OTHER;
+
+    map['\0'] = char_class::NUL;
+    for (const auto& l : LETTERS)
+        map[static_cast<unsigned char>(l)] = char_class::LETTER;
+    for (const auto& d : DIGITS)
+        map[static_cast<unsigned char>(d)] = char_class::DIGIT;
+    for (const auto& w : WHITESPACE)
+        map[static_cast<unsigned char>(w)] = char_class::WHITESPACE;
+
+    map['&'] = char_class::AMPER;
+    map['|'] = char_class::BAR;
+    map['('] = char_class::LPAREN;
+    map[')'] = char_class::RPAREN;
+    map['!'] = char_class::EXCLAM;
+    map[';'] = char_class::SEMICOLON;
+
+    // `lexer::read' reports the end of the stream as EOF
+    map[static_cast<unsigned char>(EOF)] = char_class::END;
+
+    return map;
+}
+
+constexpr auto& transition(transition_table& tbl, char_class prev, char_class cur)
+{
+    return tbl[static_cast<std::size_t>(prev)][static_cast<std::size_t>(cur)];
+}
+
+constexpr void init_operator_follow(
+    transition_table& tbl,
+    char_class prev,
+    lexer::accept_state acc)
+{
+    for (const auto cur :
+         {char_class::LETTER,
+          char_class::WHITESPACE,
+          char_class::AMPER,
+          char_class::BAR,
+          char_class::LPAREN,
+          char_class::RPAREN,
+          char_class::EXCLAM,
+          char_class::SEMICOLON,
+          char_class::END})
+        transition(tbl, prev, cur) = {lexer::table_state::ACCEPT, acc};
+}
+
+constexpr transition_table create_transition_table()
+{
+    constexpr lexer::state cont = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
+
+    transition_table tbl = {};
+    for (auto& row : tbl)
+        for (auto& col : row)
+            col = {lexer::table_state::REJECT, lexer::accept_state::NONE};
+
+    // Identifiers
+    transition(tbl, char_class::NUL, char_class::LETTER) = cont;
+    for (const auto prev : {char_class::LETTER, char_class::DIGIT})
+    {
+        init_operator_follow(tbl, prev, lexer::accept_state::IDENTIFIER);
+        transition(tbl, prev, char_class::LETTER) = cont;
+        transition(tbl, prev, char_class::DIGIT) = cont;
+    }
+
+    // Operators
+    for (const auto op :
+         {char_class::LPAREN,
+          char_class::RPAREN,
+          char_class::AMPER,
+          char_class::BAR,
+          char_class::EXCLAM})
+    {
+        transition(tbl, char_class::NUL, op) = cont;
+        init_operator_follow(tbl, op, lexer::accept_state::OPERATOR);
+    }
+    transition(tbl, char_class::AMPER, char_class::AMPER) = cont;
+    transition(tbl, char_class::BAR, char_class::BAR) = cont;
+
+    // Separators
+    transition(tbl, char_class::NUL, char_class::SEMICOLON) = cont;
+    init_operator_follow(tbl, char_class::SEMICOLON, lexer::accept_state::SEPARATOR);
+
+    // Whitespace
+    transition(tbl, char_class::NUL, char_class::WHITESPACE) = cont;
+    init_operator_follow(tbl, char_class::WHITESPACE, lexer::accept_state::WHITESPACE);
+    transition(tbl, char_class::WHITESPACE, char_class::WHITESPACE) = cont;
+
+    return tbl;
+}
+
+inline constexpr class_map CLASS_MAP = create_class_map();
+inline constexpr transition_table TRANSITIONS = create_transition_table();
+
+constexpr char_class classify(char ch) noexcept
+{
+    return CLASS_MAP[static_cast<unsigned char>(ch)];
+}
+
+constexpr const lexer::state& transition(char_class prev, char_class cur) noexcept
+{
+    return TRANSITIONS[static_cast<std::size_t>(prev)][static_cast<std::size_t>(cur)];
+}
+
+static_assert(sizeof(transition_table) <= 320, "Transition table must fit in a few cache lines");
+
+#endif
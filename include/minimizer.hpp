@@ -0,0 +1,14 @@
+#ifndef MINIMIZER_HPP
+#define MINIMIZER_HPP
+
+#include <cstddef>
+
+#include <memory>
+
+#include "expression.hpp"
+
+constexpr std::size_t MINIMIZE_BUDGET = std::size_t(1) << 10;
+
+std::unique_ptr<expression> minimize(const expression& expr, std::size_t budget = MINIMIZE_BUDGET);
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef NORMAL_FORM_HPP
+#define NORMAL_FORM_HPP
+
+#include <cstddef>
+
+#include <memory>
+
+#include "expression.hpp"
+
+enum class cnf_mode
+{
+    DISTRIBUTE,
+    TSEITIN,
+};
+
+constexpr std::size_t NORMAL_FORM_BUDGET = std::size_t(1) << 20;
+
+std::unique_ptr<expression> to_cnf(
+    const expression& expr,
+    cnf_mode mode = cnf_mode::DISTRIBUTE,
+    std::size_t budget = NORMAL_FORM_BUDGET);
+std::unique_ptr<expression> to_dnf(const expression& expr, std::size_t budget = NORMAL_FORM_BUDGET);
+
+#endif
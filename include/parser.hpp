@@ -2,7 +2,9 @@
 #define PARSER_HPP
 
 #include <optional>
+#include <vector>
 
+#include "arena.hpp"
 #include "expression.hpp"
 #include "lexer.hpp"
 
@@ -10,21 +12,34 @@ class parser
 {
 public:
     explicit parser(lexer& lex);
+    parser(lexer& lex, expression_arena& arena);
 
     std::unique_ptr<expression> parse_expression();
+    std::optional<std::unique_ptr<expression>> parse_statement();
 
 private:
+    enum class pending
+    {
+        LPAREN,
+        OR,
+        AND,
+        NOT,
+    };
+
     lexer& lex_;
+    expression_arena* arena_;
+
+    token current_token;
 
-    std::unique_ptr<token> current_token;
+    std::vector<pending> operators_;
+    std::vector<std::unique_ptr<expression>> operands_;
 
     void next();
+    void skip_separators();
 
-    std::unique_ptr<expression> parse_add_expression();
-    std::unique_ptr<expression> parse_mul_expression();
-    std::unique_ptr<expression> parse_unary_expression();
-    std::unique_ptr<expression> parse_primary_expression();
-    std::unique_ptr<expression> parse_identifier_expression();
+    void reduce();
+    void reduce_above(pending op);
+    std::unique_ptr<expression> fail();
 };
 
 #endif
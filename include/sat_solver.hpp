@@ -0,0 +1,77 @@
+#ifndef SAT_SOLVER_HPP
+#define SAT_SOLVER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <vector>
+
+class sat_solver final
+{
+public:
+    using variable = std::uint32_t;
+    using literal = std::uint32_t;
+
+    enum class result
+    {
+        SATISFIABLE,
+        UNSATISFIABLE,
+        UNKNOWN,
+    };
+
+    explicit sat_solver() noexcept;
+    sat_solver(const sat_solver&) = delete;
+    sat_solver(sat_solver&&) = delete;
+    ~sat_solver() = default;
+
+    sat_solver& operator=(const sat_solver&) = delete;
+    sat_solver& operator=(sat_solver&&) = delete;
+
+    [[nodiscard]] variable add_variable();
+    void add_clause(std::vector<literal> clause);
+
+    [[nodiscard]] result solve(std::size_t conflict_budget = DEFAULT_CONFLICT_BUDGET);
+    [[nodiscard]] bool value(variable var) const;
+
+    [[nodiscard]] std::size_t variables() const noexcept;
+    [[nodiscard]] const std::size_t& conflicts() const noexcept;
+
+    [[nodiscard]] static literal make_literal(variable var, bool negated) noexcept;
+
+    static constexpr std::size_t DEFAULT_CONFLICT_BUDGET = 10'000;
+
+private:
+    static constexpr std::uint32_t NO_CLAUSE = UINT32_MAX;
+    static constexpr std::uint32_t NOT_IN_HEAP = UINT32_MAX;
+
+    std::vector<std::vector<literal>> clauses_;
+    std::vector<std::vector<std::uint32_t>> watches_;
+    std::vector<std::int8_t> values_;
+    std::vector<bool> phases_;
+    std::vector<std::uint32_t> levels_;
+    std::vector<std::uint32_t> reasons_;
+    std::vector<double> activity_;
+    std::vector<bool> seen_;
+    std::vector<variable> heap_;
+    std::vector<std::uint32_t> heap_positions_;
+    std::vector<literal> trail_;
+    std::vector<std::size_t> trail_levels_;
+    std::size_t propagated_;
+    double bump_;
+    std::size_t conflicts_;
+    bool inconsistent_;
+
+    [[nodiscard]] std::int8_t literal_value(literal lit) const noexcept;
+    void assign(literal lit, std::uint32_t reason);
+    void attach(std::uint32_t clause);
+    [[nodiscard]] std::uint32_t propagate();
+    [[nodiscard]] std::size_t analyze(std::uint32_t conflict, std::vector<literal>& learnt);
+    void backtrack(std::size_t level);
+    void bump(variable var);
+    void heap_insert(variable var);
+    void heap_up(std::size_t pos);
+    void heap_down(std::size_t pos);
+    [[nodiscard]] bool decide();
+};
+
+#endif
@@ -0,0 +1,11 @@
+#ifndef SCANNER_HPP
+#define SCANNER_HPP
+
+#include <cstddef>
+
+#include <string_view>
+
+std::size_t scan_identifier(std::string_view text) noexcept;
+std::size_t scan_whitespace(std::string_view text) noexcept;
+
+#endif
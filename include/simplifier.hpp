@@ -1,10 +1,45 @@
 #ifndef SIMPLIFIER_HPP
 #define SIMPLIFIER_HPP
 
+#include <cstddef>
+
 #include <memory>
 
+#include "arena.hpp"
 #include "expression.hpp"
+#include "simplify_cache.hpp"
+#include "task_pool.hpp"
+
+constexpr std::size_t SIMPLIFY_PARALLEL_CUTOFF = 4096;
+
+enum class simplify_level
+{
+    REWRITE,
+    ALGEBRAIC,
+    MINIMIZE,
+};
+
+std::unique_ptr<expression>
+simplify(const expression& expr, simplify_level level = simplify_level::REWRITE);
+std::unique_ptr<expression> simplify(
+    const expression& expr,
+    simplify_cache& cache,
+    simplify_level level = simplify_level::REWRITE);
+std::unique_ptr<expression> simplify(
+    const expression& expr,
+    expression_arena& arena,
+    simplify_level level = simplify_level::REWRITE);
+std::unique_ptr<expression> simplify(
+    const expression& expr,
+    task_pool& pool,
+    simplify_level level = simplify_level::REWRITE);
+std::unique_ptr<expression>
+simplify(std::unique_ptr<expression>&& expr, simplify_level level = simplify_level::REWRITE);
 
-std::unique_ptr<expression> simplify(const expression& expr);
+std::unique_ptr<expression> to_nnf(const expression& expr, bool negate = false);
+std::unique_ptr<expression>
+to_nnf(const expression& expr, simplify_cache& cache, bool negate = false);
+std::unique_ptr<expression> to_nnf(const expression& expr, task_pool& pool, bool negate = false);
+std::unique_ptr<expression> to_nnf(std::unique_ptr<expression>&& expr, bool negate = false);
 
 #endif
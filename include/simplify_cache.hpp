@@ -0,0 +1,69 @@
+#ifndef SIMPLIFY_CACHE_HPP
+#define SIMPLIFY_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "expression.hpp"
+
+class simplify_cache final
+{
+public:
+    struct result
+    {
+        std::unique_ptr<expression> expr;
+        std::size_t nodes;
+    };
+
+    explicit simplify_cache(
+        std::size_t capacity = DEFAULT_CAPACITY,
+        std::size_t max_entry_nodes = DEFAULT_MAX_ENTRY_NODES);
+    simplify_cache(const simplify_cache&) = delete;
+    simplify_cache(simplify_cache&&) = delete;
+    ~simplify_cache() = default;
+
+    simplify_cache& operator=(const simplify_cache&) = delete;
+    simplify_cache& operator=(simplify_cache&&) = delete;
+
+    [[nodiscard]] const result* find(std::uint32_t id, bool negated);
+    void insert(std::uint32_t id, bool negated, const expression& expr, std::size_t nodes);
+    void clear() noexcept;
+
+    [[nodiscard]] std::size_t size() const noexcept;
+    [[nodiscard]] const std::size_t& capacity() const noexcept;
+    [[nodiscard]] const std::size_t& max_entry_nodes() const noexcept;
+    [[nodiscard]] const std::size_t& hits() const noexcept;
+    [[nodiscard]] const std::size_t& misses() const noexcept;
+
+    static constexpr std::size_t DEFAULT_CAPACITY = 4096;
+    static constexpr std::size_t DEFAULT_MAX_ENTRY_NODES = 1024;
+
+private:
+    static constexpr std::size_t SEEN_FACTOR = 4;
+
+    struct entry
+    {
+        std::uint64_t key;
+        result value;
+    };
+
+    std::size_t capacity_;
+    std::size_t max_entry_nodes_;
+    std::list<entry> entries_;
+    std::unordered_map<std::uint64_t, std::list<entry>::iterator> index_;
+    std::unordered_set<std::uint64_t> seen_;
+    std::size_t hits_;
+    std::size_t misses_;
+    std::uint64_t generation_;
+
+    void check_generation() noexcept;
+
+    static std::uint64_t key(std::uint32_t id, bool negated) noexcept;
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef SYMBOL_TABLE_HPP
+#define SYMBOL_TABLE_HPP
+
+#include <cstdint>
+
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class symbol_table final
+{
+public:
+    using symbol = std::uint32_t;
+
+    symbol_table(const symbol_table&) = delete;
+    symbol_table(symbol_table&&) = delete;
+    ~symbol_table() = default;
+
+    symbol_table& operator=(const symbol_table&) = delete;
+    symbol_table& operator=(symbol_table&&) = delete;
+
+    [[nodiscard]] symbol intern(std::string_view name);
+    [[nodiscard]] const std::string& name(symbol sym) const;
+    [[nodiscard]] std::size_t size() const;
+
+    [[nodiscard]] static symbol_table& instance() noexcept;
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, symbol> index_;
+
+    explicit symbol_table() noexcept;
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef TASK_POOL_HPP
+#define TASK_POOL_HPP
+
+#include <cstddef>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class task_pool final
+{
+public:
+    using task = std::function<void()>;
+
+    explicit task_pool(std::size_t workers = default_workers());
+    task_pool(const task_pool&) = delete;
+    task_pool(task_pool&&) = delete;
+    ~task_pool();
+
+    task_pool& operator=(const task_pool&) = delete;
+    task_pool& operator=(task_pool&&) = delete;
+
+    void run(task root);
+    void spawn(task t);
+
+    [[nodiscard]] std::size_t workers() const noexcept;
+
+    [[nodiscard]] static std::size_t default_workers() noexcept;
+
+private:
+    struct alignas(64) queue
+    {
+        std::mutex mutex;
+        std::deque<task> tasks;
+    };
+
+    std::unique_ptr<queue[]> queues_;
+    std::size_t workers_;
+    std::vector<std::thread> threads_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable idle_;
+    std::size_t generation_;
+    bool stopping_;
+    std::exception_ptr error_;
+    std::atomic<std::size_t> pending_;
+    std::atomic<std::size_t> sleepers_;
+
+    void work(std::size_t index);
+    void help(std::size_t index);
+    void execute(task& t);
+    void park();
+    void wake(bool all);
+    [[nodiscard]] bool has_work();
+    bool pop(std::size_t index, task& t);
+    bool steal(std::size_t index, task& t);
+};
+
+#endif
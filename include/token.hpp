@@ -4,14 +4,13 @@
 #include <cassert>
 
 #include <iosfwd>
-#include <string>
-#include <variant>
+#include <string_view>
 
 #include <fmt/format.h>
 
 #include "position.hpp"
 
-class token
+class token final
 {
 public:
     enum class type
@@ -19,48 +18,13 @@ public:
         ERROR,
         IDENTIFIER,
         OPERATOR,
+        SEPARATOR,
         END,
     };
 
-    virtual ~token() = default;
-
-    [[nodiscard]] const location& loc() const noexcept;
-    [[nodiscard]] virtual type type() const noexcept = 0;
-
-protected:
-    location loc_;
-
-    explicit token(location loc) noexcept;
-};
-
-class token_error final : public token
-{
-public:
-    explicit token_error(location loc) noexcept;
-    ~token_error() override = default;
-
-    [[nodiscard]] enum type type() const noexcept override;
-};
-
-class token_identifier final : public token
-{
-public:
-    token_identifier(location loc, std::string name);
-    ~token_identifier() override = default;
-
-    [[nodiscard]] const std::string& name() const;
-
-    [[nodiscard]] enum type type() const noexcept override;
-
-private:
-    std::string name_;
-};
-
-class token_operator final : public token
-{
-public:
     enum class kind
     {
+        NONE,
         AMPERAMPER,
         PIPEPIPE,
         EXCLAM,
@@ -68,112 +32,38 @@ public:
         RPAREN,
     };
 
-    token_operator(location loc, kind k) noexcept;
-    ~token_operator() override = default;
+    token(enum type type, location loc, std::string_view text, enum kind kind) noexcept;
+    token(const token&) noexcept = default;
+    token(token&&) noexcept = default;
+    ~token() = default;
 
-    [[nodiscard]] const kind& kind() const;
+    token& operator=(const token&) noexcept = default;
+    token& operator=(token&&) noexcept = default;
 
-    [[nodiscard]] enum type type() const noexcept override;
+    [[nodiscard]] const enum type& type() const noexcept;
+    [[nodiscard]] const location& loc() const noexcept;
+    [[nodiscard]] const std::string_view& text() const noexcept;
+    [[nodiscard]] const enum kind& kind() const noexcept;
 
 private:
+    enum type type_;
+    location loc_;
+    std::string_view text_;
     enum kind kind_;
 };
 
-class token_end final : public token
-{
-public:
-    explicit token_end(location loc) noexcept;
-    ~token_end() override = default;
-
-    [[nodiscard]] enum type type() const noexcept override;
-};
 
+token make_error_token(location loc) noexcept;
+token make_identifier_token(location loc, std::string_view name) noexcept;
+token make_operator_token(location loc, std::string_view text, enum token::kind kind) noexcept;
+token make_separator_token(location loc, std::string_view text) noexcept;
+token make_end_token(location loc) noexcept;
 
-const token_operator* match_operator_kind(const token& tok, enum token_operator::kind kind);
+bool match_operator_kind(const token& tok, enum token::kind kind) noexcept;
 
 
 namespace fmt
 {
-template<>
-struct formatter<token_error>
-{
-    constexpr auto parse(format_parse_context& ctx)
-    {
-        return ctx.begin();
-    }
-
-    template<typename FormatContext>
-    auto format(const token_error& err, FormatContext& ctx)
-    {
-        return format_to(ctx.out(), "{}: ERROR", err.loc());
-    }
-};
-
-template<>
-struct formatter<token_identifier>
-{
-    constexpr auto parse(format_parse_context& ctx)
-    {
-        return ctx.begin();
-    }
-
-    template<typename FormatContext>
-    auto format(const token_identifier& ident, FormatContext& ctx)
-    {
-        return format_to(ctx.out(), "{}: IDENT {}", ident.loc(), ident.name());
-    }
-};
-
-template<>
-struct formatter<token_operator>
-{
-    constexpr auto parse(format_parse_context& ctx)
-    {
-        return ctx.begin();
-    }
-
-    template<typename FormatContext>
-    auto format(const token_operator& op, FormatContext& ctx)
-    {
-        const auto op_str = ([&op]() {
-            switch (op.kind())
-            {
-            case token_operator::kind::EXCLAM:
-                return "!";
-
-            case token_operator::kind::AMPERAMPER:
-                return "&&";
-
-            case token_operator::kind::PIPEPIPE:
-                return "||";
-
-            case token_operator::kind::LPAREN:
-                return "(";
-
-            case token_operator::kind::RPAREN:
-                return ")";
-            }
-        })();
-
-        return format_to(ctx.out(), "{}: OP {}", op.loc(), op_str);
-    }
-};
-
-template<>
-struct formatter<token_end>
-{
-    constexpr auto parse(format_parse_context& ctx)
-    {
-        return ctx.begin();
-    }
-
-    template<typename FormatContext>
-    auto format(const token_end& end, FormatContext& ctx)
-    {
-        return format_to(ctx.out(), "{}: END", end.loc());
-    }
-};
-
 template<>
 struct formatter<token>
 {
@@ -188,29 +78,23 @@ struct formatter<token>
         switch (tok.type())
         {
         case token::type::OPERATOR:
-        {
-            const auto tok_op = dynamic_cast<const token_operator&>(tok);
-            return format_to(ctx.out(), "{}", tok_op);
-        }
+            return format_to(ctx.out(), "{}: OP {}", tok.loc(), tok.text());
 
         case token::type::IDENTIFIER:
-        {
-            const auto tok_ident = dynamic_cast<const token_identifier&>(tok);
-            return format_to(ctx.out(), "{}", tok_ident);
-        }
+            return format_to(ctx.out(), "{}: IDENT {}", tok.loc(), tok.text());
+
+        case token::type::SEPARATOR:
+            return format_to(ctx.out(), "{}: SEP", tok.loc());
 
         case token::type::END:
-        {
-            const auto tok_end = dynamic_cast<const token_end&>(tok);
-            return format_to(ctx.out(), "{}", tok_end);
-        }
+            return format_to(ctx.out(), "{}: END", tok.loc());
 
         case token::type::ERROR:
-        {
-            const auto tok_err = dynamic_cast<const token_error&>(tok);
-            return format_to(ctx.out(), "{}", tok_err);
-        }
+            return format_to(ctx.out(), "{}: ERROR", tok.loc());
         }
+
+        assert(!"Invalid token type");
+        return ctx.out();
     }
 };
 } // namespace fmt
@@ -0,0 +1,177 @@
+#include "arena.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+
+namespace
+{
+thread_local expression_arena* current_arena = nullptr;
+
+constexpr std::size_t round_up(std::size_t size, std::size_t alignment) noexcept
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+} // namespace
+
+expression_arena::expression_arena(std::size_t block_size)
+    : block_size_(round_up(std::max(block_size, ALIGNMENT), ALIGNMENT))
+    , blocks_()
+    , large_blocks_()
+    , large_bytes_(0)
+    , cursor_(nullptr)
+    , end_(nullptr)
+    , free_lists_()
+    , oversize_(nullptr)
+    , bytes_in_use_(0)
+{
+    free_lists_.fill(nullptr);
+}
+
+/**
+ * Allocates storage for a single node
+ *
+ * Storage is first taken from the free list of the matching size class,
+ * so that nodes destroyed during simplification are reused by the nodes
+ * built afterwards. Larger storage is reused if a freed block has the
+ * same size. Otherwise it is bumped off the current block. Requests
+ * larger than a whole block get a dedicated block.
+ *
+ * @param size Number of bytes requested
+ * @return Storage aligned to `ALIGNMENT'
+ */
+void* expression_arena::allocate(std::size_t size)
+{
+    size = round_up(std::max<std::size_t>(size, 1), ALIGNMENT);
+    bytes_in_use_ += size;
+
+    const auto sc = size_class(size);
+    if (sc < SIZE_CLASSES && free_lists_[sc] != nullptr)
+    {
+        auto* node = free_lists_[sc];
+        free_lists_[sc] = node->next;
+        return node;
+    }
+
+    if (sc >= SIZE_CLASSES)
+    {
+        for (auto** link = &oversize_; *link != nullptr; link = &(*link)->next)
+        {
+            if ((*link)->size != size)
+                continue;
+
+            auto* node = *link;
+            *link = node->next;
+            return node;
+        }
+    }
+
+    if (size > block_size_)
+    {
+        large_blocks_.push_back(std::make_unique<std::byte[]>(size));
+        large_bytes_ += size;
+        return large_blocks_.back().get();
+    }
+
+    if (cursor_ == nullptr || static_cast<std::size_t>(end_ - cursor_) < size)
+    {
+        blocks_.push_back(std::make_unique<std::byte[]>(block_size_));
+        cursor_ = blocks_.back().get();
+        end_ = cursor_ + block_size_;
+    }
+
+    auto* ptr = cursor_;
+    cursor_ += size;
+    return ptr;
+}
+
+/**
+ * Returns storage of a single node to the arena
+ *
+ * The storage is kept on a free list and is only handed back to the
+ * system by `release' or the arena destructor.
+ *
+ * @param ptr Storage previously returned by `allocate'
+ * @param size Size previously passed to `allocate'
+ */
+void expression_arena::deallocate(void* ptr, std::size_t size) noexcept
+{
+    size = round_up(std::max<std::size_t>(size, 1), ALIGNMENT);
+    assert(bytes_in_use_ >= size);
+    bytes_in_use_ -= size;
+
+    const auto sc = size_class(size);
+    if (sc >= SIZE_CLASSES)
+    {
+        auto* node = static_cast<oversize_node*>(ptr);
+        node->next = oversize_;
+        node->size = size;
+        oversize_ = node;
+        return;
+    }
+
+    auto* node = static_cast<free_node*>(ptr);
+    node->next = free_lists_[sc];
+    free_lists_[sc] = node;
+}
+
+/**
+ * Frees every node of the session at once
+ *
+ * No node allocated from the arena may be alive when this is called.
+ * The first block is kept so that the next session does not start with
+ * a system allocation.
+ */
+void expression_arena::release() noexcept
+{
+    free_lists_.fill(nullptr);
+    oversize_ = nullptr;
+    bytes_in_use_ = 0;
+
+    large_blocks_.clear();
+    large_bytes_ = 0;
+
+    if (blocks_.empty())
+        return;
+
+    blocks_.resize(1);
+    cursor_ = blocks_.front().get();
+    end_ = cursor_ + block_size_;
+}
+
+std::size_t expression_arena::bytes_reserved() const noexcept
+{
+    return blocks_.size() * block_size_ + large_bytes_;
+}
+
+std::size_t expression_arena::bytes_in_use() const noexcept
+{
+    return bytes_in_use_;
+}
+
+expression_arena* expression_arena::current() noexcept
+{
+    return current_arena;
+}
+
+std::size_t expression_arena::size_class(std::size_t size) noexcept
+{
+    return size / ALIGNMENT - 1;
+}
+
+
+arena_scope::arena_scope(expression_arena* arena) noexcept
+    : previous_(current_arena)
+{
+    current_arena = arena;
+}
+
+arena_scope::arena_scope(expression_arena& arena) noexcept
+    : arena_scope(&arena)
+{
+}
+
+arena_scope::~arena_scope()
+{
+    current_arena = previous_;
+}
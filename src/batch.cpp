@@ -0,0 +1,356 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "arena.hpp"
+#include "equivalence.hpp"
+#include "expression_table.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "simplifier.hpp"
+
+namespace
+{
+struct batch_diagnostic
+{
+    std::size_t expression;
+    std::string message;
+};
+
+struct batch_chunk
+{
+    std::string text;
+    fmt::memory_buffer output;
+    std::vector<batch_diagnostic> diagnostics;
+    batch_result result;
+};
+
+/**
+ * Cuts the input into chunks of about `BATCH_CHUNK_SIZE' bytes, each
+ * ending right after a line break or a `;', so that no expression spans
+ * two chunks
+ */
+class chunk_reader final
+{
+public:
+    explicit chunk_reader(input_source& in) noexcept
+        : in_(in)
+        , view_()
+        , offset_(0)
+        , end_(false)
+    {
+    }
+
+    [[nodiscard]] bool read(std::string& text)
+    {
+        text.clear();
+        while (!end_)
+        {
+            if (offset_ == view_.size())
+            {
+                view_ = in_.next(0);
+                offset_ = 0;
+                end_ = view_.empty();
+                continue;
+            }
+
+            const auto rest = view_.substr(offset_);
+            const auto missing = BATCH_CHUNK_SIZE - std::min(text.size(), BATCH_CHUNK_SIZE);
+            const auto cut = rest.find_first_of("\n;", missing == 0 ? 0 : missing - 1);
+            if (cut == std::string_view::npos)
+            {
+                text += rest;
+                offset_ = view_.size();
+                continue;
+            }
+
+            text += rest.substr(0, cut + 1);
+            offset_ += cut + 1;
+            return true;
+        }
+
+        return !text.empty();
+    }
+
+private:
+    input_source& in_;
+    std::string_view view_;
+    std::size_t offset_;
+    bool end_;
+};
+
+/**
+ * Demorganizes every expression of a chunk into its output buffer
+ *
+ * Lexer diagnostics are turned off, since their positions would be
+ * relative to the chunk. Errors are recorded with the number of the
+ * expression within the chunk instead, to be reported once the chunks
+ * before it are done.
+ */
+void process_chunk(batch_chunk& chunk, expression_arena& arena, bool verify)
+{
+    input_string in(chunk.text);
+    lexer lex(in);
+    lex.set_newline_separators(true);
+    lex.set_semicolon_separators(true);
+    lex.set_diagnostics(false);
+    parser par(lex, arena);
+
+    chunk.output.clear();
+    chunk.diagnostics.clear();
+    chunk.result = {0, 0, 0};
+
+    for (;;)
+    {
+        auto statement = par.parse_statement();
+        if (!statement)
+            break;
+
+        const auto index = ++chunk.result.expressions;
+        if (*statement == nullptr)
+        {
+            chunk.diagnostics.push_back({index, "Error: Invalid expression"});
+            chunk.result.errors++;
+        }
+        else
+        {
+            const arena_scope scope(arena);
+            auto& expr = *statement;
+            auto nnf = verify ? to_nnf(*expr, true) : to_nnf(std::move(expr), true);
+            const auto final = make_unary(expression_unary::kind::NOT, std::move(nnf));
+            print_expression(chunk.output, *final);
+
+            if (verify)
+            {
+                const auto check = check_equivalence(*expr, *final);
+                if (check.status != equivalence_status::EQUIVALENT)
+                {
+                    chunk.diagnostics.push_back({index, verification_message(check)});
+                    chunk.result.failures++;
+                }
+            }
+        }
+        chunk.output.push_back('\n');
+
+        // Every node of the expression is gone by now
+        statement.reset();
+        arena.release();
+    }
+}
+
+/**
+ * Runs `process_chunk' over a round of chunks on a fixed set of threads
+ *
+ * The calling thread takes part as the first worker, and every worker
+ * keeps its own arena. Chunks are handed out one at a time, so that
+ * uneven chunks do not leave threads idle before the end of the round.
+ */
+class chunk_pool final
+{
+public:
+    chunk_pool(std::size_t jobs, bool verify)
+        : threads_()
+        , arenas_(jobs)
+        , mutex_()
+        , start_()
+        , done_()
+        , generation_(0)
+        , busy_(0)
+        , stopping_(false)
+        , chunks_(nullptr)
+        , count_(0)
+        , next_(0)
+        , verify_(verify)
+    {
+        for (std::size_t worker = 1; worker < jobs; worker++)
+            threads_.emplace_back([this, worker] { work(worker); });
+    }
+
+    chunk_pool(const chunk_pool&) = delete;
+    chunk_pool(chunk_pool&&) = delete;
+
+    ~chunk_pool()
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        start_.notify_all();
+
+        for (auto& thread : threads_)
+            thread.join();
+    }
+
+    chunk_pool& operator=(const chunk_pool&) = delete;
+    chunk_pool& operator=(chunk_pool&&) = delete;
+
+    void start(batch_chunk* chunks, std::size_t count)
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            chunks_ = chunks;
+            count_ = count;
+            next_.store(0, std::memory_order_relaxed);
+            busy_ = threads_.size();
+            generation_++;
+        }
+        start_.notify_all();
+    }
+
+    void finish()
+    {
+        drain(arenas_.front());
+
+        std::unique_lock lock(mutex_);
+        done_.wait(lock, [this] { return busy_ == 0; });
+    }
+
+private:
+    std::vector<std::thread> threads_;
+    std::deque<expression_arena> arenas_;
+    std::mutex mutex_;
+    std::condition_variable start_;
+    std::condition_variable done_;
+    std::size_t generation_;
+    std::size_t busy_;
+    bool stopping_;
+    batch_chunk* chunks_;
+    std::size_t count_;
+    std::atomic<std::size_t> next_;
+    bool verify_;
+
+    void work(std::size_t worker)
+    {
+        for (std::size_t seen = 0;;)
+        {
+            {
+                std::unique_lock lock(mutex_);
+                start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+                if (stopping_)
+                    return;
+                seen = generation_;
+            }
+
+            drain(arenas_[worker]);
+
+            const std::lock_guard lock(mutex_);
+            if (--busy_ == 0)
+                done_.notify_one();
+        }
+    }
+
+    void drain(expression_arena& arena)
+    {
+        for (;;)
+        {
+            const auto index = next_.fetch_add(1, std::memory_order_relaxed);
+            if (index >= count_)
+                return;
+            process_chunk(chunks_[index], arena, verify_);
+        }
+    }
+};
+
+std::size_t read_round(chunk_reader& reader, std::vector<batch_chunk>& chunks)
+{
+    std::size_t count = 0;
+    while (count < chunks.size() && reader.read(chunks[count].text))
+        count++;
+    return count;
+}
+
+void write_round(
+    const std::vector<batch_chunk>& chunks,
+    std::size_t count,
+    std::ostream& out,
+    batch_result& result)
+{
+    for (std::size_t i = 0; i < count; i++)
+    {
+        const auto& chunk = chunks[i];
+        out.write(chunk.output.data(), static_cast<std::streamsize>(chunk.output.size()));
+
+        for (const auto& diagnostic : chunk.diagnostics)
+            std::cerr << fmt::format(
+                "Expression {}: {}\n",
+                result.expressions + diagnostic.expression,
+                diagnostic.message);
+
+        result.expressions += chunk.result.expressions;
+        result.errors += chunk.result.errors;
+        result.failures += chunk.result.failures;
+    }
+}
+} // namespace
+
+/**
+ * Demorganizes every expression of `in', writing one result per line to
+ * `out'
+ *
+ * Expressions are separated by line breaks or `;'. The result of each is
+ * its demorganized form in infix notation, or an empty line if it could
+ * not be parsed. The error is then reported on `std::cerr' by the number
+ * of the expression, and processing goes on with the next one.
+ *
+ * The input is cut into chunks at expression boundaries, and rounds of
+ * `BATCH_CHUNKS_PER_JOB' chunks per job are processed on `jobs' threads.
+ * Results and errors are written in input order, while the next round is
+ * being processed, so the output does not depend on the number of jobs.
+ *
+ * Memory does not grow with the input. Nodes are allocated from per
+ * thread arenas released after every expression, and the hash-consing
+ * table is cleared between rounds whenever it holds more than
+ * `BATCH_TABLE_LIMIT' structures. Only the symbol table keeps growing,
+ * with the number of distinct identifiers.
+ *
+ * @param in The input
+ * @param out The stream the results are written to
+ * @param verify Whether to check every result for equivalence with its
+ * expression, reporting differences on `std::cerr'
+ * @param jobs Number of threads to process expressions on
+ * @return Numbers of expressions, of parse errors and of failed checks
+ */
+batch_result run_batch(input_source& in, std::ostream& out, bool verify, std::size_t jobs)
+{
+    jobs = std::max<std::size_t>(jobs, 1);
+
+    chunk_pool pool(jobs, verify);
+    chunk_reader reader(in);
+
+    std::vector<batch_chunk> pending(jobs * BATCH_CHUNKS_PER_JOB);
+    std::vector<batch_chunk> done(pending.size());
+    auto pending_count = read_round(reader, pending);
+    std::size_t done_count = 0;
+
+    batch_result result = {0, 0, 0};
+    while (pending_count > 0)
+    {
+        pool.start(pending.data(), pending_count);
+        write_round(done, done_count, out, result);
+        done_count = read_round(reader, done);
+        pool.finish();
+
+        // No node is alive and no thread is interning between rounds
+        if (expression_table::instance().size() > BATCH_TABLE_LIMIT)
+            expression_table::instance().clear();
+
+        std::swap(pending, done);
+        std::swap(pending_count, done_count);
+    }
+
+    write_round(done, done_count, out, result);
+    return result;
+}
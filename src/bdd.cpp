@@ -0,0 +1,836 @@
+#include "bdd.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+#include <numeric>
+#include <utility>
+
+#include "minimizer.hpp"
+
+namespace
+{
+// Sifting stops moving a variable in one direction once the diagram
+// grows past this factor of the best size seen
+constexpr double MAX_GROWTH = 1.2;
+
+// Garbage is only collected once there are this many dead nodes, and at
+// least as many as live ones
+constexpr std::size_t MIN_GARBAGE = 1024;
+
+constexpr std::size_t INITIAL_BUCKETS = 8;
+
+std::size_t round_up_pow2(std::size_t size) noexcept
+{
+    std::size_t result = 1;
+    while (result < size)
+        result <<= 1;
+    return result;
+}
+
+std::size_t hash(std::uint32_t f, std::uint32_t g, std::uint32_t h) noexcept
+{
+    auto x = std::uint64_t(f) * 0x9E3779B97F4A7C15 ^ std::uint64_t(g) * 0xC2B2AE3D27D4EB4F
+        ^ std::uint64_t(h) * 0x165667B19E3779F9;
+    return static_cast<std::size_t>(x ^ (x >> 29));
+}
+} // namespace
+
+bdd::bdd(bdd_manager& manager, node_ref node) noexcept
+    : manager_(&manager)
+    , node_(node)
+{
+    manager_->ref(node_);
+}
+
+bdd::bdd(const bdd& src) noexcept
+    : manager_(src.manager_)
+    , node_(src.node_)
+{
+    manager_->ref(node_);
+}
+
+bdd::bdd(bdd&& src) noexcept
+    : manager_(src.manager_)
+    , node_(src.node_)
+{
+    src.node_ = bdd_manager::FALSE;
+}
+
+bdd::~bdd()
+{
+    manager_->deref(node_);
+}
+
+bdd& bdd::operator=(const bdd& src) noexcept
+{
+    src.manager_->ref(src.node_);
+    manager_->deref(node_);
+    manager_ = src.manager_;
+    node_ = src.node_;
+    return *this;
+}
+
+bdd& bdd::operator=(bdd&& src) noexcept
+{
+    std::swap(manager_, src.manager_);
+    std::swap(node_, src.node_);
+    return *this;
+}
+
+bdd_manager& bdd::manager() const noexcept
+{
+    return *manager_;
+}
+
+/**
+ * Returns the root node of the diagram
+ *
+ * Nodes are shared within their manager, so two diagrams of the same
+ * manager represent the same function if and only if they have the same
+ * root node.
+ */
+const bdd::node_ref& bdd::node() const noexcept
+{
+    return node_;
+}
+
+bool bdd::is_true() const noexcept
+{
+    return node_ == bdd_manager::TRUE;
+}
+
+bool bdd::is_false() const noexcept
+{
+    return node_ == bdd_manager::FALSE;
+}
+
+
+/**
+ * Creates an empty manager
+ *
+ * @param cache_size Number of entries of the ITE cache, rounded up to a
+ *                   power of two
+ */
+bdd_manager::bdd_manager(std::size_t cache_size)
+    : nodes_({{TERMINAL, FALSE, FALSE, 0, NO_NODE}, {TERMINAL, TRUE, TRUE, 0, NO_NODE}})
+    , free_()
+    , unique_()
+    , levels_()
+    , order_()
+    , symbols_()
+    , variable_index_()
+    , cache_(round_up_pow2(std::max<std::size_t>(cache_size, 1)), {NO_NODE, 0, 0, 0})
+    , dead_(0)
+    , auto_reorder_(false)
+    , next_reorder_(FIRST_REORDER_SIZE)
+{
+}
+
+bdd bdd_manager::constant(bool value)
+{
+    return bdd(*this, value ? TRUE : FALSE);
+}
+
+/**
+ * Returns the diagram of the variable `sym'
+ *
+ * Variables are created on first use, below all the existing ones.
+ */
+bdd bdd_manager::variable_of(symbol_table::symbol sym)
+{
+    return bdd(*this, make_node(intern_variable(sym), FALSE, TRUE));
+}
+
+/**
+ * Returns the diagram of IF `f' THEN `g' ELSE `h'
+ *
+ * Every Boolean operation is an ITE, e.g. AND(f, g) is ITE(f, g, FALSE).
+ * The diagrams must belong to this manager.
+ */
+bdd bdd_manager::ite(const bdd& f, const bdd& g, const bdd& h)
+{
+    maintain();
+    return bdd(*this, ite(f.node(), g.node(), h.node()));
+}
+
+/**
+ * Builds the diagram of an expression without recursing
+ *
+ * The operands of an n-ary node are combined from the left. Garbage
+ * collection and automatic reordering may run between two operations,
+ * while every intermediate diagram is referenced.
+ *
+ * @param expr The expression to convert
+ * @return The diagram of `expr'
+ */
+bdd bdd_manager::from_expression(const expression& expr)
+{
+    std::vector<std::pair<const expression*, bool>> pending = {{&expr, false}};
+    std::vector<node_ref> values;
+
+    while (!pending.empty())
+    {
+        const auto* node = pending.back().first;
+        const auto expanded = pending.back().second;
+        pending.pop_back();
+
+        visit(
+            *node,
+            overloaded{
+                [&](const expression_identifier& ident) {
+                    values.push_back(make_node(intern_variable(ident.symbol()), FALSE, TRUE));
+                    ref(values.back());
+                },
+                [&](const expression_unary& unary) {
+                    if (expanded)
+                    {
+                        const auto inner = values.back();
+                        values.back() = ite(inner, FALSE, TRUE);
+                        ref(values.back());
+                        deref(inner);
+                        return;
+                    }
+                    pending.emplace_back(&unary, true);
+                    pending.emplace_back(&unary.inner(), false);
+                },
+                [&](const expression_binary& binary) {
+                    const auto& operands = binary.operands();
+                    if (!expanded)
+                    {
+                        pending.emplace_back(&binary, true);
+                        for (auto it = operands.rbegin(); it != operands.rend(); it++)
+                            pending.emplace_back(it->get(), false);
+                        return;
+                    }
+
+                    const auto is_and = binary.op() == expression_binary::kind::AND;
+                    const auto first = values.size() - operands.size();
+                    auto acc = values[first];
+                    for (auto i = first + 1; i < values.size(); i++)
+                    {
+                        const auto next =
+                            is_and ? ite(acc, values[i], FALSE) : ite(acc, TRUE, values[i]);
+                        ref(next);
+                        deref(acc);
+                        deref(values[i]);
+                        acc = next;
+                        maintain();
+                    }
+                    values.resize(first);
+                    values.push_back(acc);
+                },
+            });
+    }
+
+    bdd result(*this, values.back());
+    deref(values.back());
+    return result;
+}
+
+/**
+ * Extracts a minimal expression from a diagram
+ *
+ * The diagram is first turned into an irredundant sum of products with
+ * the Minato-Morreale algorithm, which works on the diagram itself and
+ * shares the covers of common subfunctions, so its cost follows the size
+ * of the diagram rather than the size of the expression. The sum of
+ * products is then handed to `minimize', and kept as it is if it has too
+ * many cubes for it. The constants are spelled out with the top variable
+ * of the order, as <X> AND NOT(<X>) and <X> OR NOT(<X>).
+ *
+ * @param f The diagram to convert
+ * @param budget Maximum number of cubes of the sum of products
+ * @return Owning reference to the expression, or `nullptr' if `f' is a
+ *         constant and the manager has no variables, or if the sum of
+ *         products has more than `budget' cubes
+ */
+std::unique_ptr<expression> bdd_manager::to_expression(const bdd& f, std::size_t budget)
+{
+    if (f.node() == FALSE || f.node() == TRUE)
+    {
+        if (order_.empty())
+            return nullptr;
+
+        const auto sym = symbols_[order_.front()];
+        return make_binary(
+            f.node() == TRUE ? expression_binary::kind::OR : expression_binary::kind::AND,
+            make_identifier(sym),
+            make_unary(expression_unary::kind::NOT, make_identifier(sym)));
+    }
+
+    // No garbage is collected before the next operation, so the nodes
+    // built on the way need no references
+    std::vector<cube_set> sets(2, {TERMINAL, NO_CUBES, NO_CUBES, NO_CUBES});
+    std::unordered_map<std::uint64_t, isop_result> memo;
+    const auto root = isop(f.node(), f.node(), sets, memo).cubes;
+
+    // Sets only refer to the ones built before them
+    std::vector<std::size_t> counts = {0, 1};
+    for (auto i = counts.size(); i < sets.size(); i++)
+    {
+        const auto& set = sets[i];
+        counts.push_back(
+            std::min(counts[set.negative] + counts[set.positive] + counts[set.both], budget + 1));
+    }
+    if (counts[root] > budget)
+        return nullptr;
+
+    std::vector<std::pair<variable, bool>> literals;
+    expression_binary::operand_list terms;
+    append_cubes(sets, root, literals, terms);
+
+    auto sop = terms.size() == 1 ? std::move(terms.front())
+                                 : make_binary(expression_binary::kind::OR, std::move(terms));
+    auto minimal = minimize(*sop);
+    if (minimal == nullptr || minimal->nodes() >= sop->nodes())
+        return sop;
+    return minimal;
+}
+
+/**
+ * Reorders the variables by sifting
+ *
+ * Variables are taken from the one with the most nodes down. Each is
+ * moved through every level by swapping adjacent levels in place, which
+ * keeps the root of every diagram, and is then put back where the
+ * diagram was smallest.
+ */
+void bdd_manager::reorder()
+{
+    collect_garbage();
+
+    std::vector<variable> vars(order_.size());
+    std::iota(vars.begin(), vars.end(), 0);
+    std::stable_sort(
+        vars.begin(),
+        vars.end(),
+        [this](variable l, variable r) { return unique_[l].count > unique_[r].count; });
+
+    for (const auto var : vars)
+        sift(var);
+
+    std::fill(cache_.begin(), cache_.end(), cache_entry {NO_NODE, 0, 0, 0});
+}
+
+/**
+ * Frees the nodes no diagram refers to and clears the ITE cache
+ */
+void bdd_manager::collect_garbage()
+{
+    for (node_ref f = TRUE + 1; f < nodes_.size(); f++)
+        if (nodes_[f].var != FREED && nodes_[f].refs == 0)
+            release(f);
+
+    assert(dead_ == 0);
+    std::fill(cache_.begin(), cache_.end(), cache_entry {NO_NODE, 0, 0, 0});
+}
+
+/**
+ * Enables reordering whenever the number of live nodes has doubled since
+ * the last reordering, starting at `FIRST_REORDER_SIZE'
+ */
+void bdd_manager::set_auto_reorder(bool enabled) noexcept
+{
+    auto_reorder_ = enabled;
+}
+
+/**
+ * Returns the number of live non-terminal nodes
+ */
+std::size_t bdd_manager::size() const noexcept
+{
+    return nodes_.size() - 2 - free_.size() - dead_;
+}
+
+/**
+ * Returns the number of non-terminal nodes of a diagram
+ */
+std::size_t bdd_manager::count_nodes(const bdd& f) const
+{
+    std::vector<bool> visited(nodes_.size());
+    std::vector<node_ref> pending = {f.node()};
+    std::size_t count = 0;
+
+    while (!pending.empty())
+    {
+        const auto g = pending.back();
+        pending.pop_back();
+        if (g <= TRUE || visited[g])
+            continue;
+
+        visited[g] = true;
+        count++;
+        pending.push_back(nodes_[g].low);
+        pending.push_back(nodes_[g].high);
+    }
+
+    return count;
+}
+
+std::size_t bdd_manager::variables() const noexcept
+{
+    return order_.size();
+}
+
+/**
+ * Returns the variables from the top level of the diagrams down
+ */
+const std::vector<bdd_manager::variable>& bdd_manager::order() const noexcept
+{
+    return order_;
+}
+
+symbol_table::symbol bdd_manager::symbol(variable var) const
+{
+    return symbols_[var];
+}
+
+bdd_manager::variable bdd_manager::intern_variable(symbol_table::symbol sym)
+{
+    const auto [it, inserted] =
+        variable_index_.emplace(sym, static_cast<variable>(symbols_.size()));
+    if (inserted)
+    {
+        symbols_.push_back(sym);
+        levels_.push_back(static_cast<std::uint32_t>(order_.size()));
+        order_.push_back(it->second);
+        unique_.push_back({std::vector<node_ref>(INITIAL_BUCKETS, NO_NODE), 0});
+    }
+    return it->second;
+}
+
+/**
+ * Returns the level of the variable of `f', terminals being below all
+ */
+std::uint32_t bdd_manager::level(node_ref f) const noexcept
+{
+    const auto var = nodes_[f].var;
+    return var == TERMINAL ? UINT32_MAX : levels_[var];
+}
+
+/**
+ * Returns the node (`var', `low', `high') from the unique table
+ *
+ * A node whose children are equal is its child. New nodes start without
+ * references, so they count as dead until something refers to them.
+ */
+bdd_manager::node_ref bdd_manager::make_node(variable var, node_ref low, node_ref high)
+{
+    if (low == high)
+        return low;
+
+    for (auto f = bucket(var, low, high); f != NO_NODE; f = nodes_[f].next)
+        if (nodes_[f].low == low && nodes_[f].high == high)
+            return f;
+
+    node_ref f;
+    if (!free_.empty())
+    {
+        f = free_.back();
+        free_.pop_back();
+        nodes_[f] = {var, low, high, 0, NO_NODE};
+    }
+    else
+    {
+        f = static_cast<node_ref>(nodes_.size());
+        nodes_.push_back({var, low, high, 0, NO_NODE});
+    }
+
+    insert_unique(f);
+    dead_++;
+    ref(low);
+    ref(high);
+    return f;
+}
+
+/**
+ * Returns the node of IF `f' THEN `g' ELSE `h'
+ *
+ * This recurses on the cofactors of the topmost variable, so its depth
+ * is bounded by the number of variables. Results are kept in a
+ * direct-mapped cache, which is cleared whenever nodes are freed.
+ */
+bdd_manager::node_ref bdd_manager::ite(node_ref f, node_ref g, node_ref h)
+{
+    if (f == TRUE)
+        return g;
+    if (f == FALSE)
+        return h;
+    if (g == f)
+        g = TRUE;
+    if (h == f)
+        h = FALSE;
+    if (g == h)
+        return g;
+    if (g == TRUE && h == FALSE)
+        return f;
+
+    const auto slot = hash(f, g, h) & (cache_.size() - 1);
+    if (const auto& entry = cache_[slot]; entry.f == f && entry.g == g && entry.h == h)
+        return entry.result;
+
+    const auto top = std::min({level(f), level(g), level(h)});
+    const auto cofactor = [this, top](node_ref x, bool high)
+    {
+        if (level(x) != top)
+            return x;
+        return high ? nodes_[x].high : nodes_[x].low;
+    };
+
+    const auto then_node = ite(cofactor(f, true), cofactor(g, true), cofactor(h, true));
+    const auto else_node = ite(cofactor(f, false), cofactor(g, false), cofactor(h, false));
+    const auto result = make_node(order_[top], else_node, then_node);
+
+    cache_[slot] = {f, g, h, result};
+    return result;
+}
+
+/**
+ * Returns the head of the chain of nodes of `var' with children `low'
+ * and `high'
+ */
+bdd_manager::node_ref& bdd_manager::bucket(variable var, node_ref low, node_ref high) noexcept
+{
+    auto& table = unique_[var];
+    auto x = (std::uint64_t(low) << 32 | high) * 0x9E3779B97F4A7C15;
+    return table.buckets[static_cast<std::size_t>(x >> 32) & (table.buckets.size() - 1)];
+}
+
+/**
+ * Adds `f' to the unique table of its variable, doubling the number of
+ * buckets once there are as many nodes
+ */
+void bdd_manager::insert_unique(node_ref f)
+{
+    auto& table = unique_[nodes_[f].var];
+    if (table.count >= table.buckets.size())
+    {
+        auto buckets = std::move(table.buckets);
+        table.buckets.assign(buckets.size() * 2, NO_NODE);
+        for (auto head : buckets)
+        {
+            while (head != NO_NODE)
+            {
+                const auto next = nodes_[head].next;
+                auto& slot = bucket(nodes_[head].var, nodes_[head].low, nodes_[head].high);
+                nodes_[head].next = slot;
+                slot = head;
+                head = next;
+            }
+        }
+    }
+
+    auto& slot = bucket(nodes_[f].var, nodes_[f].low, nodes_[f].high);
+    nodes_[f].next = slot;
+    slot = f;
+    table.count++;
+}
+
+void bdd_manager::erase_unique(node_ref f) noexcept
+{
+    auto* link = &bucket(nodes_[f].var, nodes_[f].low, nodes_[f].high);
+    while (*link != f)
+        link = &nodes_[*link].next;
+    *link = nodes_[f].next;
+    unique_[nodes_[f].var].count--;
+}
+
+void bdd_manager::ref(node_ref f) noexcept
+{
+    if (f > TRUE && nodes_[f].refs++ == 0)
+        dead_--;
+}
+
+void bdd_manager::deref(node_ref f) noexcept
+{
+    if (f > TRUE && --nodes_[f].refs == 0)
+        dead_++;
+}
+
+/**
+ * Frees the dead node `f', and the nodes that die with it
+ */
+void bdd_manager::release(node_ref f)
+{
+    std::vector<node_ref> pending = {f};
+    while (!pending.empty())
+    {
+        const auto g = pending.back();
+        pending.pop_back();
+
+        const auto low = nodes_[g].low;
+        const auto high = nodes_[g].high;
+        assert(nodes_[g].refs == 0);
+        erase_unique(g);
+        nodes_[g].var = FREED;
+        free_.push_back(g);
+        dead_--;
+
+        for (const auto child : {low, high})
+        {
+            deref(child);
+            if (child > TRUE && nodes_[child].refs == 0)
+                pending.push_back(child);
+        }
+    }
+}
+
+/**
+ * Collects garbage or reorders when it is due
+ *
+ * Only called between two operations, when every node that is still
+ * needed is referenced.
+ */
+void bdd_manager::maintain()
+{
+    if (auto_reorder_ && size() >= next_reorder_)
+    {
+        reorder();
+        next_reorder_ = std::max(FIRST_REORDER_SIZE, 2 * size());
+        return;
+    }
+
+    if (dead_ >= MIN_GARBAGE && dead_ >= size())
+        collect_garbage();
+}
+
+/**
+ * Swaps the variables at levels `upper' and `upper' + 1 in place
+ *
+ * A node of the upper variable x that depends on the lower variable y is
+ * rewritten into a node of y over two new nodes of x, so it keeps both
+ * its index and its function. Nodes of x that do not depend on y just
+ * move down with x. Nodes of y that are no longer referred to are freed
+ * right away, so the size of the diagram stays exact while sifting.
+ */
+void bdd_manager::swap_levels(std::uint32_t upper)
+{
+    const auto x = order_[upper];
+    const auto y = order_[upper + 1];
+
+    std::vector<node_ref> xs;
+    xs.reserve(unique_[x].count);
+    for (auto head : unique_[x].buckets)
+        for (; head != NO_NODE; head = nodes_[head].next)
+            xs.push_back(head);
+
+    for (const auto f : xs)
+    {
+        const auto f0 = nodes_[f].low;
+        const auto f1 = nodes_[f].high;
+        const auto y0 = nodes_[f0].var == y;
+        const auto y1 = nodes_[f1].var == y;
+        if (!y0 && !y1)
+            continue;
+
+        const auto f00 = y0 ? nodes_[f0].low : f0;
+        const auto f01 = y0 ? nodes_[f0].high : f0;
+        const auto f10 = y1 ? nodes_[f1].low : f1;
+        const auto f11 = y1 ? nodes_[f1].high : f1;
+
+        const auto low = make_node(x, f00, f10);
+        ref(low);
+        const auto high = make_node(x, f01, f11);
+        ref(high);
+
+        erase_unique(f);
+        nodes_[f].var = y;
+        nodes_[f].low = low;
+        nodes_[f].high = high;
+        insert_unique(f);
+
+        for (const auto child : {f0, f1})
+        {
+            deref(child);
+            if (child > TRUE && nodes_[child].refs == 0)
+                release(child);
+        }
+    }
+
+    order_[upper] = y;
+    order_[upper + 1] = x;
+    levels_[x] = upper + 1;
+    levels_[y] = upper;
+}
+
+/**
+ * Moves `var' to the closer end of the order, then to the other end,
+ * and back to the level where the diagram was smallest
+ */
+void bdd_manager::sift(variable var)
+{
+    auto best_size = size();
+    auto best_level = levels_[var];
+
+    const auto track = [&]
+    {
+        if (size() < best_size)
+        {
+            best_size = size();
+            best_level = levels_[var];
+        }
+        return static_cast<double>(size()) <= MAX_GROWTH * static_cast<double>(best_size);
+    };
+    const auto move_down = [&]
+    {
+        while (levels_[var] + 1 < order_.size())
+        {
+            swap_levels(levels_[var]);
+            if (!track())
+                break;
+        }
+    };
+    const auto move_up = [&]
+    {
+        while (levels_[var] > 0)
+        {
+            swap_levels(levels_[var] - 1);
+            if (!track())
+                break;
+        }
+    };
+
+    if (2 * levels_[var] >= order_.size())
+    {
+        move_down();
+        move_up();
+    }
+    else
+    {
+        move_up();
+        move_down();
+    }
+
+    while (levels_[var] < best_level)
+        swap_levels(levels_[var]);
+    while (levels_[var] > best_level)
+        swap_levels(levels_[var] - 1);
+}
+
+/**
+ * Returns an irredundant sum of products of some function between
+ * `lower' and `upper', along with that function
+ *
+ * On the top variable x, the cubes that need NOT(x), those that need x
+ * and those that need neither are found in turn, each in the part of the
+ * interval the previous ones left uncovered. Results are memoized on the
+ * interval, and the recursion is bounded by the number of variables.
+ */
+bdd_manager::isop_result bdd_manager::isop(
+    node_ref lower,
+    node_ref upper,
+    std::vector<cube_set>& sets,
+    std::unordered_map<std::uint64_t, isop_result>& memo)
+{
+    if (lower == FALSE)
+        return {FALSE, NO_CUBES};
+    if (upper == TRUE)
+        return {TRUE, EMPTY_CUBE};
+
+    const auto key = std::uint64_t(lower) << 32 | upper;
+    if (const auto it = memo.find(key); it != memo.end())
+        return it->second;
+
+    const auto top = std::min(level(lower), level(upper));
+    const auto cofactor = [this, top](node_ref x, bool high)
+    {
+        if (level(x) != top)
+            return x;
+        return high ? nodes_[x].high : nodes_[x].low;
+    };
+
+    const auto lower0 = cofactor(lower, false);
+    const auto lower1 = cofactor(lower, true);
+    const auto upper0 = cofactor(upper, false);
+    const auto upper1 = cofactor(upper, true);
+
+    // ITE(g, FALSE, f) is f AND NOT(g), ITE(f, TRUE, g) is f OR g
+    const auto negative = isop(ite(upper1, FALSE, lower0), upper0, sets, memo);
+    const auto positive = isop(ite(upper0, FALSE, lower1), upper1, sets, memo);
+    const auto rest =
+        ite(ite(negative.function, FALSE, lower0), TRUE, ite(positive.function, FALSE, lower1));
+    const auto both = isop(rest, ite(upper0, upper1, FALSE), sets, memo);
+
+    isop_result result = {
+        make_node(
+            order_[top],
+            ite(negative.function, TRUE, both.function),
+            ite(positive.function, TRUE, both.function)),
+        both.cubes};
+    if (negative.cubes != NO_CUBES || positive.cubes != NO_CUBES)
+    {
+        result.cubes = static_cast<std::uint32_t>(sets.size());
+        sets.push_back({order_[top], negative.cubes, positive.cubes, both.cubes});
+    }
+
+    memo.emplace(key, result);
+    return result;
+}
+
+/**
+ * Appends the cubes of `set' to `terms', each as the AND of `literals'
+ * and of its own literals
+ */
+void bdd_manager::append_cubes(
+    const std::vector<cube_set>& sets,
+    std::uint32_t set,
+    std::vector<std::pair<variable, bool>>& literals,
+    expression_binary::operand_list& terms) const
+{
+    if (set == NO_CUBES)
+        return;
+
+    if (set == EMPTY_CUBE)
+    {
+        expression_binary::operand_list factors;
+        for (const auto& [var, negated] : literals)
+        {
+            std::unique_ptr<expression> ident = make_identifier(symbols_[var]);
+            if (negated)
+                ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+            factors.push_back(std::move(ident));
+        }
+
+        terms.push_back(
+            factors.size() == 1
+                ? std::move(factors.front())
+                : make_binary(expression_binary::kind::AND, std::move(factors)));
+        return;
+    }
+
+    const auto [var, negative, positive, both] = sets[set];
+    literals.emplace_back(var, true);
+    append_cubes(sets, negative, literals, terms);
+    literals.back().second = false;
+    append_cubes(sets, positive, literals, terms);
+    literals.pop_back();
+    append_cubes(sets, both, literals, terms);
+}
+
+bool operator==(const bdd& l, const bdd& r) noexcept
+{
+    assert(&l.manager() == &r.manager());
+    return l.node() == r.node();
+}
+
+bool operator!=(const bdd& l, const bdd& r) noexcept
+{
+    return !(l == r);
+}
+
+bdd bdd_not(const bdd& f)
+{
+    auto& manager = f.manager();
+    return manager.ite(f, manager.constant(false), manager.constant(true));
+}
+
+bdd bdd_and(const bdd& l, const bdd& r)
+{
+    return l.manager().ite(l, r, l.manager().constant(false));
+}
+
+bdd bdd_or(const bdd& l, const bdd& r)
+{
+    return l.manager().ite(l, l.manager().constant(true), r);
+}
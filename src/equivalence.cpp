@@ -0,0 +1,265 @@
+#include "equivalence.hpp"
+
+#include <cstdint>
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <fmt/format.h>
+
+#include "evaluator.hpp"
+
+namespace
+{
+using word = evaluator::word;
+using literal = sat_solver::literal;
+using assignment = std::vector<std::pair<symbol_table::symbol, bool>>;
+
+// Seed of the sampled assignments, fixed so that runs are reproducible
+constexpr std::uint64_t SAMPLE_SEED = 0x9E3779B97F4A7C15;
+
+/**
+ * Returns the assignment of `variables' in which variable `v' is bit `v'
+ * of `index', as enumerated by `evaluator::truth_table'
+ */
+assignment table_assignment(const std::vector<symbol_table::symbol>& variables, std::size_t index)
+{
+    assignment result;
+    for (std::size_t v = 0; v < variables.size(); v++)
+        result.emplace_back(variables[v], ((index >> v) & 1) != 0);
+    return result;
+}
+
+/**
+ * Returns the assignment at bit `bit' of word `index' of the inputs of
+ * `evaluator::evaluate', which hold `words' words per variable
+ */
+assignment input_assignment(
+    const std::vector<symbol_table::symbol>& variables,
+    const std::vector<word>& inputs,
+    std::size_t words,
+    std::size_t index,
+    std::size_t bit)
+{
+    assignment result;
+    for (std::size_t v = 0; v < variables.size(); v++)
+        result.emplace_back(variables[v], ((inputs[v * words + index] >> bit) & 1) != 0);
+    return result;
+}
+
+/**
+ * Encodes programs of an `evaluator' into a `sat_solver' as an
+ * and-inverter graph
+ *
+ * Variable `v' of the evaluator is variable `v' of the solver, followed
+ * by a variable that is always true. OR is an AND of the negations, and
+ * gates are hashed on their inputs, so that the parts two expressions
+ * share are encoded once and the solver only searches where they differ.
+ */
+class gate_encoder final
+{
+public:
+    gate_encoder(sat_solver& solver, std::size_t inputs)
+        : solver_(solver)
+        , gates_()
+        , true_()
+    {
+        for (std::size_t v = 0; v <= inputs; v++)
+            (void)solver_.add_variable();
+        true_ = sat_solver::make_literal(static_cast<sat_solver::variable>(inputs), false);
+        solver_.add_clause({true_});
+    }
+
+    /**
+     * Returns the literal that holds the value of the program of `eval'
+     */
+    literal encode(const evaluator& eval)
+    {
+        std::vector<literal> stack;
+        for (const auto& ins : eval.program())
+        {
+            switch (ins.op)
+            {
+            case evaluator::opcode::LOAD:
+                stack.push_back(sat_solver::make_literal(ins.variable, false));
+                break;
+
+            case evaluator::opcode::NOT:
+                stack.back() ^= 1;
+                break;
+
+            case evaluator::opcode::AND:
+            case evaluator::opcode::OR:
+            {
+                const literal invert = ins.op == evaluator::opcode::OR ? 1 : 0;
+                const auto right = stack.back() ^ invert;
+                stack.pop_back();
+                stack.back() = gate(stack.back() ^ invert, right) ^ invert;
+                break;
+            }
+            }
+        }
+        return stack.back();
+    }
+
+private:
+    sat_solver& solver_;
+    std::unordered_map<std::uint64_t, literal> gates_;
+    literal true_;
+
+    literal gate(literal a, literal b)
+    {
+        if (a > b)
+            std::swap(a, b);
+
+        const auto false_lit = true_ ^ 1;
+        if (a == b || b == true_)
+            return a;
+        if (a == (b ^ 1) || a == false_lit || b == false_lit)
+            return false_lit;
+        if (a == true_)
+            return b;
+
+        const auto [it, inserted] = gates_.emplace(std::uint64_t(a) << 32 | b, 0);
+        if (!inserted)
+            return it->second;
+
+        const auto g = sat_solver::make_literal(solver_.add_variable(), false);
+        solver_.add_clause({g ^ 1, a});
+        solver_.add_clause({g ^ 1, b});
+        solver_.add_clause({g, a ^ 1, b ^ 1});
+        it->second = g;
+        return g;
+    }
+};
+} // namespace
+
+/**
+ * Decides whether two expressions are equivalent
+ *
+ * Both expressions are compiled to `evaluator's over the union of their
+ * variables. Up to `EXHAUSTIVE_VARIABLES' variables their truth tables
+ * are compared. Past that, 64 * `SAMPLE_WORDS' random assignments are
+ * evaluated first, which finds most differences cheaply, and the rest is
+ * proven by asking a `sat_solver' for an assignment under which the two
+ * differ.
+ *
+ * @param left The first expression
+ * @param right The second expression
+ * @param conflict_budget Conflicts after which the SAT check gives up
+ * @return Whether the expressions are equivalent, how that was decided,
+ *         and an assignment of every variable under which they differ if
+ *         they are not; `UNKNOWN' means the sampling found no difference
+ *         but the SAT check ran out of budget
+ */
+equivalence_result check_equivalence(
+    const expression& left,
+    const expression& right,
+    std::size_t conflict_budget)
+{
+    const evaluator left_eval(left);
+    const evaluator right_eval(right, left_eval.variables());
+    const auto& variables = right_eval.variables();
+    const auto n = variables.size();
+
+    if (n <= EXHAUSTIVE_VARIABLES)
+    {
+        // `left_eval' numbers a prefix of the variables of `right_eval'
+        const auto left_table = left_eval.truth_table(n);
+        const auto right_table = right_eval.truth_table();
+
+        for (std::size_t i = 0; i < left_table.size(); i++)
+        {
+            const auto diff = left_table[i] ^ right_table[i];
+            if (diff != 0)
+            {
+                return {
+                    equivalence_status::DIFFERENT,
+                    equivalence_method::EXHAUSTIVE,
+                    table_assignment(variables, i * 64 + __builtin_ctzll(diff))};
+            }
+        }
+        return {equivalence_status::EQUIVALENT, equivalence_method::EXHAUSTIVE, {}};
+    }
+
+    std::mt19937_64 rng(SAMPLE_SEED);
+    std::vector<word> inputs(n * SAMPLE_WORDS);
+    for (auto& input : inputs)
+        input = rng();
+
+    std::vector<word> left_out(SAMPLE_WORDS);
+    std::vector<word> right_out(SAMPLE_WORDS);
+    left_eval.evaluate(inputs.data(), left_out.data(), SAMPLE_WORDS);
+    right_eval.evaluate(inputs.data(), right_out.data(), SAMPLE_WORDS);
+
+    for (std::size_t i = 0; i < SAMPLE_WORDS; i++)
+    {
+        const auto diff = left_out[i] ^ right_out[i];
+        if (diff != 0)
+        {
+            return {
+                equivalence_status::DIFFERENT,
+                equivalence_method::SAMPLING,
+                input_assignment(variables, inputs, SAMPLE_WORDS, i, __builtin_ctzll(diff))};
+        }
+    }
+
+    sat_solver solver;
+    gate_encoder encoder(solver, n);
+    const auto left_out_lit = encoder.encode(left_eval);
+    const auto right_out_lit = encoder.encode(right_eval);
+
+    // The miter: the outputs differ
+    solver.add_clause({left_out_lit, right_out_lit});
+    solver.add_clause({left_out_lit ^ 1, right_out_lit ^ 1});
+
+    switch (solver.solve(conflict_budget))
+    {
+    case sat_solver::result::UNSATISFIABLE:
+        return {equivalence_status::EQUIVALENT, equivalence_method::SAT, {}};
+
+    case sat_solver::result::SATISFIABLE:
+    {
+        assignment counterexample;
+        for (std::size_t v = 0; v < n; v++)
+            counterexample.emplace_back(
+                variables[v], solver.value(static_cast<sat_solver::variable>(v)));
+        return {equivalence_status::DIFFERENT, equivalence_method::SAT, counterexample};
+    }
+
+    case sat_solver::result::UNKNOWN:
+        break;
+    }
+
+    return {equivalence_status::UNKNOWN, equivalence_method::SAT, {}};
+}
+
+/**
+ * Describes why an expression could not be shown equivalent to its
+ * demorganized form
+ *
+ * @param result A check that did not find the expressions equivalent
+ * @return The message, without the number of the expression
+ */
+std::string verification_message(const equivalence_result& result)
+{
+    if (result.status == equivalence_status::UNKNOWN)
+        return "Error: Equivalence could not be proven";
+
+    std::string assignment;
+    for (const auto& [sym, value] : result.counterexample)
+        assignment += fmt::format(" {}={}", symbol_table::instance().name(sym), value ? 1 : 0);
+    return fmt::format("Error: Demorganized expression differs at{}", assignment);
+}
+
+/**
+ * Reports on `std::cerr' that the expression number `index' could not be
+ * shown equivalent to its demorganized form
+ */
+void report_verification(std::size_t index, const equivalence_result& result)
+{
+    std::cerr << fmt::format("Expression {}: {}\n", index, verification_message(result));
+}
@@ -0,0 +1,442 @@
+#include "evaluator.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define EVALUATOR_X86 1
+    #include <immintrin.h>
+#else
+    #define EVALUATOR_X86 0
+#endif
+
+namespace
+{
+using word = evaluator::word;
+using opcode = evaluator::opcode;
+using instruction = evaluator::instruction;
+
+// Words every instruction is applied to at once; each stack slot holds
+// one block, so the dispatch of an instruction is paid once per 1024
+// assignments instead of once per 64
+constexpr std::size_t BLOCK_WORDS = 16;
+
+// Words of a truth table that are evaluated together, which bounds the
+// size of the buffer of input patterns
+constexpr std::size_t CHUNK_WORDS = 64 * BLOCK_WORDS;
+
+constexpr std::size_t WORD_VARIABLES = 6;
+
+using run_fn = void (*)(
+    const instruction*,
+    const instruction*,
+    const word*,
+    std::size_t,
+    std::size_t,
+    word*,
+    word*) noexcept;
+
+/**
+ * Runs the program in [begin, end) on `count' <= `BLOCK_WORDS' words
+ *
+ * Variable `v' is read from inputs[v * stride], and `stack' must hold
+ * a block for every value the program keeps alive at once.
+ */
+void run_scalar(
+    const instruction* begin,
+    const instruction* end,
+    const word* inputs,
+    std::size_t stride,
+    std::size_t count,
+    word* output,
+    word* stack) noexcept
+{
+    auto* top = stack;
+    for (const auto* ins = begin; ins != end; ins++)
+    {
+        switch (ins->op)
+        {
+        case opcode::LOAD:
+            std::copy_n(inputs + ins->variable * stride, count, top);
+            top += BLOCK_WORDS;
+            break;
+
+        case opcode::NOT:
+            for (std::size_t i = 0; i < count; i++)
+                top[i - BLOCK_WORDS] = ~top[i - BLOCK_WORDS];
+            break;
+
+        case opcode::AND:
+            top -= BLOCK_WORDS;
+            for (std::size_t i = 0; i < count; i++)
+                top[i - BLOCK_WORDS] &= top[i];
+            break;
+
+        case opcode::OR:
+            top -= BLOCK_WORDS;
+            for (std::size_t i = 0; i < count; i++)
+                top[i - BLOCK_WORDS] |= top[i];
+            break;
+        }
+    }
+    std::copy_n(stack, count, output);
+}
+
+#if EVALUATOR_X86
+constexpr std::size_t AVX2_LANES = 4;
+
+__attribute__((target("avx2"))) __m256i load(const word* ptr) noexcept
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ptr));
+}
+
+__attribute__((target("avx2"))) void store(word* ptr, __m256i x) noexcept
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(ptr), x);
+}
+
+/**
+ * Runs the program 256 assignments at a time
+ *
+ * @see run_scalar
+ */
+__attribute__((target("avx2"))) void run_avx2(
+    const instruction* begin,
+    const instruction* end,
+    const word* inputs,
+    std::size_t stride,
+    std::size_t count,
+    word* output,
+    word* stack) noexcept
+{
+    if (count != BLOCK_WORDS)
+    {
+        run_scalar(begin, end, inputs, stride, count, output, stack);
+        return;
+    }
+
+    const auto ones = _mm256_set1_epi64x(-1);
+    auto* top = stack;
+    for (const auto* ins = begin; ins != end; ins++)
+    {
+        switch (ins->op)
+        {
+        case opcode::LOAD:
+            for (std::size_t i = 0; i < BLOCK_WORDS; i += AVX2_LANES)
+                store(top + i, load(inputs + ins->variable * stride + i));
+            top += BLOCK_WORDS;
+            break;
+
+        case opcode::NOT:
+            for (std::size_t i = 0; i < BLOCK_WORDS; i += AVX2_LANES)
+            {
+                auto* slot = top - BLOCK_WORDS + i;
+                store(slot, _mm256_xor_si256(load(slot), ones));
+            }
+            break;
+
+        case opcode::AND:
+            top -= BLOCK_WORDS;
+            for (std::size_t i = 0; i < BLOCK_WORDS; i += AVX2_LANES)
+            {
+                auto* slot = top - BLOCK_WORDS + i;
+                store(slot, _mm256_and_si256(load(slot), load(top + i)));
+            }
+            break;
+
+        case opcode::OR:
+            top -= BLOCK_WORDS;
+            for (std::size_t i = 0; i < BLOCK_WORDS; i += AVX2_LANES)
+            {
+                auto* slot = top - BLOCK_WORDS + i;
+                store(slot, _mm256_or_si256(load(slot), load(top + i)));
+            }
+            break;
+        }
+    }
+    std::copy_n(stack, BLOCK_WORDS, output);
+}
+#endif
+
+run_fn select_run() noexcept
+{
+#if EVALUATOR_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return run_avx2;
+#endif
+
+    return run_scalar;
+}
+
+const run_fn RUN = select_run();
+
+// Bit `i' of the pattern of variable `v' < 6 is bit `v' of `i'
+constexpr word PATTERNS[WORD_VARIABLES] = {
+    0xAAAAAAAAAAAAAAAA,
+    0xCCCCCCCCCCCCCCCC,
+    0xF0F0F0F0F0F0F0F0,
+    0xFF00FF00FF00FF00,
+    0xFFFF0000FFFF0000,
+    0xFFFFFFFF00000000,
+};
+} // namespace
+
+/**
+ * Compiles `expr' with its variables numbered in order of first appearance
+ *
+ * @param expr The expression to compile
+ */
+evaluator::evaluator(const expression& expr)
+    : evaluator(expr, {})
+{
+}
+
+/**
+ * Compiles `expr' with the variables of `variables' numbered first
+ *
+ * Identifiers of `expr' that are not in `variables' are numbered after
+ * them in order of first appearance, so that two expressions compiled
+ * with the same list read the same inputs for the symbols they share.
+ *
+ * @param expr The expression to compile
+ * @param variables The symbols to number first, without duplicates
+ */
+evaluator::evaluator(const expression& expr, std::vector<symbol_table::symbol> variables)
+    : variables_(std::move(variables))
+    , depth_(0)
+{
+    compile(expr);
+}
+
+/**
+ * Returns the symbols of the variables, indexed by variable number
+ */
+const std::vector<symbol_table::symbol>& evaluator::variables() const noexcept
+{
+    return variables_;
+}
+
+/**
+ * Returns the postfix program the expression was compiled to
+ *
+ * A `LOAD' pushes the value of a variable, `NOT' replaces the top of
+ * the stack and `AND' and `OR' replace the two topmost values with one.
+ */
+const std::vector<evaluator::instruction>& evaluator::program() const noexcept
+{
+    return program_;
+}
+
+/**
+ * Evaluates the expression for 64 assignments at once
+ *
+ * @param inputs One word per variable, whose bit `i' is the value of the
+ *               variable in assignment `i'
+ * @return The word whose bit `i' is the value in assignment `i'
+ */
+evaluator::word evaluator::evaluate(const word* inputs) const
+{
+    word result = 0;
+    evaluate(inputs, &result, 1);
+    return result;
+}
+
+/**
+ * Evaluates the expression for 64 * `words' assignments
+ *
+ * The program is run over blocks of words, 256 assignments per
+ * instruction with AVX2 when the CPU supports it.
+ *
+ * @param inputs `words' words per variable, variable `v' starting at
+ *               inputs[v * words]
+ * @param outputs Receives the `words' words of results
+ * @param words Number of words of every variable
+ */
+void evaluator::evaluate(const word* inputs, word* outputs, std::size_t words) const
+{
+    std::vector<word> stack(depth_ * BLOCK_WORDS);
+    const auto* begin = program_.data();
+    const auto* end = begin + program_.size();
+
+    for (std::size_t i = 0; i < words; i += BLOCK_WORDS)
+    {
+        const auto count = std::min(BLOCK_WORDS, words - i);
+        RUN(begin, end, inputs + i, words, count, outputs + i, stack.data());
+    }
+}
+
+/**
+ * Returns the truth table of the expression
+ *
+ * Bit `i % 64' of word `i / 64' is the value of the expression when
+ * every variable `v' is bit `v' of `i'. Tables of fewer than six
+ * variables take one word, whose unused bits are zero.
+ *
+ * @return The 2^n / 64 words of the table, or an empty vector when there
+ *         are more than `MAX_TRUTH_TABLE_VARIABLES' variables
+ */
+std::vector<evaluator::word> evaluator::truth_table() const
+{
+    return truth_table(variables_.size());
+}
+
+/**
+ * Returns the truth table of the expression over its first `variables'
+ * variables
+ *
+ * Variables past the ones of the expression are enumerated too, so that
+ * the tables of expressions compiled with a common list of variables
+ * (@see evaluator(const expression&, std::vector<symbol_table::symbol>))
+ * can be compared word by word.
+ *
+ * @param variables Number of variables to enumerate, at least the
+ *                  number of variables of the expression
+ */
+std::vector<evaluator::word> evaluator::truth_table(std::size_t variables) const
+{
+    const auto n = variables;
+    if (n > MAX_TRUTH_TABLE_VARIABLES || n < variables_.size())
+        return {};
+
+    const auto words = n > WORD_VARIABLES ? std::size_t(1) << (n - WORD_VARIABLES) : 1;
+    std::vector<word> table(words);
+    std::vector<word> inputs(n * std::min(words, CHUNK_WORDS));
+
+    for (std::size_t first = 0; first < words; first += CHUNK_WORDS)
+    {
+        const auto count = std::min(CHUNK_WORDS, words - first);
+        for (std::size_t v = 0; v < n; v++)
+            for (std::size_t i = 0; i < count; i++)
+                inputs[v * count + i] = variable_pattern(v, first + i);
+        evaluate(inputs.data(), table.data() + first, count);
+    }
+
+    if (n < WORD_VARIABLES)
+        table[0] &= (word(1) << (std::size_t(1) << n)) - 1;
+    return table;
+}
+
+/**
+ * Returns word `index' of the inputs of variable `variable' that
+ * enumerate every assignment, as used by `truth_table'
+ */
+evaluator::word evaluator::variable_pattern(std::size_t variable, std::size_t index) noexcept
+{
+    if (variable < WORD_VARIABLES)
+        return PATTERNS[variable];
+    return ((index >> (variable - WORD_VARIABLES)) & 1) != 0 ? ~word(0) : 0;
+}
+
+/**
+ * Emits the postfix program of `expr' without recursing
+ *
+ * The operands of an n-ary node are folded into an accumulator one at a
+ * time, and since AND and OR are commutative they are emitted in order
+ * of decreasing stack need (Sethi-Ullman), so that the stack of even a
+ * deep chain of alternating operators stays a few blocks high.
+ */
+void evaluator::compile(const expression& expr)
+{
+    std::unordered_map<symbol_table::symbol, std::uint32_t> index;
+    for (std::size_t i = 0; i < variables_.size(); i++)
+        index.emplace(variables_[i], static_cast<std::uint32_t>(i));
+
+    // Stack blocks every node needs, computed in post-order
+    std::unordered_map<const expression*, std::size_t> need;
+    std::vector<std::pair<const expression*, bool>> pending = {{&expr, false}};
+    while (!pending.empty())
+    {
+        const auto* node = pending.back().first;
+        const auto expanded = pending.back().second;
+        pending.pop_back();
+
+        visit(
+            *node,
+            overloaded{
+                [&](const expression_identifier&) { need[node] = 1; },
+                [&](const expression_unary& unary) {
+                    if (expanded)
+                        need[node] = need[&unary.inner()];
+                    else
+                    {
+                        pending.emplace_back(node, true);
+                        pending.emplace_back(&unary.inner(), false);
+                    }
+                },
+                [&](const expression_binary& binary) {
+                    const auto& operands = binary.operands();
+                    if (!expanded)
+                    {
+                        pending.emplace_back(node, true);
+                        for (const auto& operand : operands)
+                            pending.emplace_back(operand.get(), false);
+                        return;
+                    }
+
+                    std::size_t first = 0;
+                    std::size_t second = 0;
+                    for (const auto& operand : operands)
+                    {
+                        const auto n = need[operand.get()];
+                        second = std::max(second, std::min(first, n));
+                        first = std::max(first, n);
+                    }
+                    need[node] = std::max(first, second + 1);
+                },
+            });
+    }
+    depth_ = need[&expr];
+
+    // A null node stands for the instruction `op' applied to the values
+    // on top of the stack
+    std::vector<std::pair<const expression*, opcode>> emit = {{&expr, opcode::LOAD}};
+    std::vector<const expression*> order;
+    while (!emit.empty())
+    {
+        const auto [node, op] = emit.back();
+        emit.pop_back();
+
+        if (node == nullptr)
+        {
+            program_.push_back({op, 0});
+            continue;
+        }
+
+        visit(
+            *node,
+            overloaded{
+                [&](const expression_identifier& ident) {
+                    const auto [it, inserted] = index.emplace(
+                        ident.symbol(), static_cast<std::uint32_t>(variables_.size()));
+                    if (inserted)
+                        variables_.push_back(ident.symbol());
+                    program_.push_back({opcode::LOAD, it->second});
+                },
+                [&](const expression_unary& unary) {
+                    emit.emplace_back(nullptr, opcode::NOT);
+                    emit.emplace_back(&unary.inner(), opcode::LOAD);
+                },
+                [&](const expression_binary& binary) {
+                    const auto fold =
+                        binary.op() == expression_binary::kind::AND ? opcode::AND : opcode::OR;
+                    order.clear();
+                    for (const auto& operand : binary.operands())
+                        order.push_back(operand.get());
+                    std::stable_sort(
+                        order.begin(),
+                        order.end(),
+                        [&need](const expression* l, const expression* r)
+                        { return need[l] > need[r]; });
+
+                    for (std::size_t i = order.size(); i-- > 1;)
+                    {
+                        emit.emplace_back(nullptr, fold);
+                        emit.emplace_back(order[i], opcode::LOAD);
+                    }
+                    emit.emplace_back(order[0], opcode::LOAD);
+                },
+            });
+    }
+}
@@ -1,27 +1,195 @@
 #include "expression.hpp"
 
-expression::expression() noexcept
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "arena.hpp"
+#include "expression_table.hpp"
+
+namespace
+{
+// Every node is prefixed with the arena it was allocated from (or `nullptr'
+// for the global heap), so that it can be handed back to it on destruction
+constexpr auto NODE_HEADER = expression_arena::ALIGNMENT;
+static_assert(NODE_HEADER >= sizeof(expression_arena*));
+
+std::uint32_t tag(enum expression::type type, int op) noexcept
+{
+    return static_cast<std::uint32_t>(type) << 8 | static_cast<std::uint32_t>(op);
+}
+
+// Node counts saturate rather than wrap around on huge trees
+std::uint32_t saturate(std::uint64_t nodes) noexcept
+{
+    return static_cast<std::uint32_t>(
+        std::min<std::uint64_t>(nodes, std::numeric_limits<std::uint32_t>::max()));
+}
+
+bool is_leaf(const std::unique_ptr<expression>& expr) noexcept
+{
+    return expr == nullptr || expr->type() == expression::type::IDENTIFIER;
+}
+
+/**
+ * Destroys the given subtrees without recursing
+ *
+ * Every node has its operands moved out onto an explicit stack before it
+ * is destroyed, so its own destructor has nothing left to recurse into.
+ * This keeps destroying a degenerate tree with millions of levels from
+ * overflowing the call stack.
+ */
+void destroy(std::vector<std::unique_ptr<expression>> pending)
+{
+    while (!pending.empty())
+    {
+        auto expr = std::move(pending.back());
+        pending.pop_back();
+
+        if (expr == nullptr)
+            continue;
+
+        switch (expr->type())
+        {
+        case expression::type::BINARY:
+            for (auto& operand : static_cast<expression_binary&>(*expr).take_operands())
+                pending.push_back(std::move(operand));
+            break;
+
+        case expression::type::UNARY:
+            pending.push_back(static_cast<expression_unary&>(*expr).take_inner());
+            break;
+
+        case expression::type::IDENTIFIER:
+            break;
+        }
+    }
+}
+} // namespace
+
+expression::expression(std::uint32_t id, std::uint32_t nodes) noexcept
+    : id_(id)
+    , nodes_(nodes)
+{
+}
+
+/**
+ * Returns the hash-consed id of the expression
+ *
+ * Ids are handed out by `expression_table', which interns the structure
+ * of every node when it is constructed, under the lock of one of its
+ * shards. Two expressions have the same id if and only if they are
+ * structurally equal.
+ *
+ * @return Id of the expression
+ */
+const std::uint32_t& expression::id() const noexcept
+{
+    return id_;
+}
+
+/**
+ * Returns the number of nodes of the expression
+ *
+ * The count is kept up to date along with the id, so it is known without
+ * walking the tree. It saturates at the largest `std::uint32_t'.
+ *
+ * @return Number of nodes, this one included
+ */
+const std::uint32_t& expression::nodes() const noexcept
+{
+    return nodes_;
+}
+
+void expression::set_id(std::uint32_t id) noexcept
+{
+    id_ = id;
+}
+
+void expression::set_nodes(std::uint32_t nodes) noexcept
+{
+    nodes_ = nodes;
+}
+
+/**
+ * Allocates a node from the arena of the current `arena_scope'
+ *
+ * Outside of any scope the node is allocated from the global heap, so
+ * code that does not care about arenas keeps working unchanged.
+ *
+ * @param size Size of the node
+ * @return Storage for the node
+ */
+void* expression::operator new(std::size_t size)
 {
+    auto* arena = expression_arena::current();
+    auto* block = static_cast<std::byte*>(
+        arena != nullptr ? arena->allocate(NODE_HEADER + size)
+                         : ::operator new(NODE_HEADER + size));
+
+    *reinterpret_cast<expression_arena**>(block) = arena;
+    return block + NODE_HEADER;
+}
+
+void expression::operator delete(void* ptr, std::size_t size) noexcept
+{
+    if (ptr == nullptr)
+        return;
+
+    auto* block = static_cast<std::byte*>(ptr) - NODE_HEADER;
+    auto* arena = *reinterpret_cast<expression_arena**>(block);
+
+    if (arena != nullptr)
+        arena->deallocate(block, NODE_HEADER + size);
+    else
+        ::operator delete(block);
 }
 
 
+expression_binary::expression_binary(kind op, operand_list operands)
+    : expression(0, 0)
+    , op_(op)
+    , operands_(std::move(operands))
+{
+    normalize();
+}
+
 expression_binary::expression_binary(
     kind op,
     std::unique_ptr<expression> left,
     std::unique_ptr<expression> right)
-    : expression()
+    : expression(0, 0)
     , op_(op)
-    , left_(std::move(left))
-    , right_(std::move(right))
+    , operands_()
 {
+    operands_.reserve(2);
+    operands_.push_back(std::move(left));
+    operands_.push_back(std::move(right));
+    normalize();
 }
 
 expression_binary::expression_binary(const expression_binary& src)
-    : expression()
+    : expression(src)
     , op_(src.op_)
-    , left_(src.left_->clone())
-    , right_(src.right_->clone())
+    , operands_()
 {
+    operands_.reserve(src.operands_.size());
+    for (const auto& operand : src.operands_)
+        operands_.push_back(operand->clone());
+}
+
+expression_binary::~expression_binary()
+{
+    for (const auto& operand : operands_)
+    {
+        if (!is_leaf(operand))
+        {
+            destroy(std::move(operands_));
+            return;
+        }
+    }
 }
 
 const expression_binary::kind& expression_binary::op() const noexcept
@@ -29,19 +197,51 @@ const expression_binary::kind& expression_binary::op() const noexcept
     return op_;
 }
 
-const expression& expression_binary::left() const noexcept
+/**
+ * Returns the operands of the node
+ *
+ * A node with operands <EXPR1>, <EXPR2>, ..., <EXPRN> stands for the
+ * right-nested chain <EXPR1> op (<EXPR2> op (... op <EXPRN>)), which is
+ * how the parser reads a chain of the same operator. Its last operand is
+ * never a node with the same operator, since that would be part of the
+ * chain, so every chain has exactly one representation.
+ *
+ * @return The operands of the node, at least two
+ */
+const expression_binary::operand_list& expression_binary::operands() const noexcept
+{
+    return operands_;
+}
+
+/**
+ * Moves the operands out of the node
+ *
+ * The node is left incomplete until it is given new operands with
+ * `assign', and may only be assigned to or destroyed until then.
+ *
+ * @return The operands of the node
+ */
+expression_binary::operand_list expression_binary::take_operands() noexcept
 {
-    return *left_;
+    return std::move(operands_);
 }
 
-const expression& expression_binary::right() const noexcept
+/**
+ * Reuses the node for a new binary expression
+ *
+ * @param op The new operator
+ * @param operands The new operands, at least two
+ */
+void expression_binary::assign(kind op, operand_list operands)
 {
-    return *right_;
+    op_ = op;
+    operands_ = std::move(operands);
+    normalize();
 }
 
 std::unique_ptr<expression> expression_binary::clone() const
 {
-    return std::make_unique<expression_binary>(op_, left_->clone(), right_->clone());
+    return std::make_unique<expression_binary>(*this);
 }
 
 enum expression::type expression_binary::type() const noexcept
@@ -49,21 +249,92 @@ enum expression::type expression_binary::type() const noexcept
     return type::BINARY;
 }
 
+/**
+ * Returns the id of `left' op `right'
+ *
+ * This is the id a two operand node would have, and lets the id of a
+ * chain be computed without building it.
+ *
+ * @param op The operator
+ * @param left Id of the left operand
+ * @param right Id of the right operand
+ * @return Id of the expression
+ */
+std::uint32_t expression_binary::fold_id(kind op, std::uint32_t left, std::uint32_t right)
+{
+    return expression_table::instance().intern(
+        tag(type::BINARY, static_cast<int>(op)), left, right);
+}
+
+/**
+ * Splices a last operand with the same operator into the node and
+ * computes its id and node count
+ *
+ * The id is the one of the right-nested chain of two operand nodes the
+ * node stands for, so it compares equal to the same chain however it was
+ * built.
+ */
+void expression_binary::normalize()
+{
+    assert(operands_.size() >= 2);
+
+    // Operands before the last one are folded into the id of the last one
+    const auto unfolded = operands_.size() - 1;
+    auto id = operands_.back()->id();
+
+    auto& last = *operands_.back();
+    if (last.type() == type::BINARY && static_cast<expression_binary&>(last).op_ == op_)
+    {
+        const auto tail = std::move(operands_.back());
+        auto& chain = static_cast<expression_binary&>(*tail).operands_;
+
+        operands_.pop_back();
+        operands_.insert(
+            operands_.end(),
+            std::make_move_iterator(chain.begin()),
+            std::make_move_iterator(chain.end()));
+        chain.clear();
+    }
+
+    for (auto i = unfolded; i-- > 0;)
+        id = fold_id(op_, operands_[i]->id(), id);
+
+    std::uint64_t nodes = 1;
+    for (const auto& operand : operands_)
+        nodes += operand->nodes();
+
+    set_id(id);
+    set_nodes(saturate(nodes));
+}
+
 
 expression_unary::expression_unary(kind op, std::unique_ptr<expression> inner)
-    : expression()
+    : expression(
+        expression_table::instance().intern(
+            tag(type::UNARY, static_cast<int>(op)), inner->id(), 0),
+        saturate(std::uint64_t(inner->nodes()) + 1))
     , op_(op)
     , inner_(std::move(inner))
 {
 }
 
 expression_unary::expression_unary(const expression_unary& src)
-    : expression()
+    : expression(src)
     , op_(src.op_)
     , inner_(src.inner_->clone())
 {
 }
 
+expression_unary::~expression_unary()
+{
+    if (is_leaf(inner_))
+        return;
+
+    std::vector<std::unique_ptr<expression>> pending;
+    pending.push_back(std::move(inner_));
+    destroy(std::move(pending));
+}
+
 const expression_unary::kind& expression_unary::op() const noexcept
 {
     return op_;
@@ -74,9 +345,35 @@ const expression& expression_unary::inner() const noexcept
     return *inner_;
 }
 
+/**
+ * Moves the operand out of the node
+ *
+ * @see expression_binary::take_operands
+ * @return Owning reference to the operand
+ */
+std::unique_ptr<expression> expression_unary::take_inner() noexcept
+{
+    return std::move(inner_);
+}
+
+/**
+ * Reuses the node for a new unary expression
+ *
+ * @param op The new operator
+ * @param inner The new operand
+ */
+void expression_unary::assign(kind op, std::unique_ptr<expression> inner)
+{
+    set_id(expression_table::instance().intern(
+        tag(type::UNARY, static_cast<int>(op)), inner->id(), 0));
+    set_nodes(saturate(std::uint64_t(inner->nodes()) + 1));
+    op_ = op;
+    inner_ = std::move(inner);
+}
+
 std::unique_ptr<expression> expression_unary::clone() const
 {
-    return std::make_unique<expression_unary>(op_, inner_->clone());
+    return std::make_unique<expression_unary>(*this);
 }
 
 enum expression::type expression_unary::type() const noexcept
@@ -85,26 +382,36 @@ enum expression::type expression_unary::type() const noexcept
 }
 
 
-expression_identifier::expression_identifier(std::string name)
-    : expression()
-    , name_(std::move(name))
+expression_identifier::expression_identifier(symbol_table::symbol sym)
+    : expression(expression_table::instance().intern(tag(type::IDENTIFIER, 0), sym, 0), 1)
+    , symbol_(sym)
+{
+}
+
+expression_identifier::expression_identifier(std::string_view name)
+    : expression_identifier(symbol_table::instance().intern(name))
 {
 }
 
 expression_identifier::expression_identifier(const expression_identifier& src)
-    : expression()
-    , name_(src.name_)
+    : expression(src)
+    , symbol_(src.symbol_)
+{
+}
+
+const symbol_table::symbol& expression_identifier::symbol() const noexcept
 {
+    return symbol_;
 }
 
-const std::string& expression_identifier::name() const noexcept
+const std::string& expression_identifier::name() const
 {
-    return name_;
+    return symbol_table::instance().name(symbol_);
 }
 
 std::unique_ptr<expression> expression_identifier::clone() const
 {
-    return std::make_unique<expression_identifier>(name_);
+    return std::make_unique<expression_identifier>(*this);
 }
 
 enum expression::type expression_identifier::type() const noexcept
@@ -113,34 +420,15 @@ enum expression::type expression_identifier::type() const noexcept
 }
 
 
+/**
+ * Compares two expressions structurally
+ *
+ * Thanks to hash-consing this is a single comparison of ids, regardless
+ * of the size of the expressions.
+ */
 bool operator==(const expression& l, const expression& r)
 {
-    if (l.type() != r.type())
-        return false;
-
-    switch (l.type())
-    {
-    case expression::type::BINARY:
-    {
-        const auto& l_binary = dynamic_cast<const expression_binary&>(l);
-        const auto& r_binary = dynamic_cast<const expression_binary&>(r);
-        return l_binary == r_binary;
-    }
-
-    case expression::type::UNARY:
-    {
-        const auto& l_unary = dynamic_cast<const expression_unary&>(l);
-        const auto& r_unary = dynamic_cast<const expression_binary&>(r);
-        return l_unary == r_unary;
-    }
-
-    case expression::type::IDENTIFIER:
-    {
-        const auto& l_ident = dynamic_cast<const expression_identifier&>(l);
-        const auto& r_ident = dynamic_cast<const expression_identifier&>(r);
-        return l_ident == r_ident;
-    }
-    }
+    return l.id() == r.id();
 }
 
 bool operator!=(const expression& l, const expression& r)
@@ -150,7 +438,7 @@ bool operator!=(const expression& l, const expression& r)
 
 bool operator==(const expression_binary& l, const expression_binary& r)
 {
-    return l.op() == r.op() && l.left() == r.left() && l.right() == r.right();
+    return l.id() == r.id();
 }
 
 bool operator!=(const expression_binary& l, const expression_binary& r)
@@ -160,7 +448,7 @@ bool operator!=(const expression_binary& l, const expression_binary& r)
 
 bool operator==(const expression_unary& l, const expression_unary& r)
 {
-    return l.op() == r.op() && l.inner() == r.inner();
+    return l.id() == r.id();
 }
 
 bool operator!=(const expression_unary& l, const expression_unary& r)
@@ -170,7 +458,7 @@ bool operator!=(const expression_unary& l, const expression_unary& r)
 
 bool operator==(const expression_identifier& l, const expression_identifier& r)
 {
-    return l.name() == r.name();
+    return l.id() == r.id();
 }
 
 bool operator!=(const expression_identifier& l, const expression_identifier& r)
@@ -187,13 +475,168 @@ std::unique_ptr<expression_binary> make_binary(
     return std::make_unique<expression_binary>(kind, std::move(left), std::move(right));
 }
 
+std::unique_ptr<expression_binary>
+make_binary(expression_binary::kind kind, expression_binary::operand_list operands)
+{
+    return std::make_unique<expression_binary>(kind, std::move(operands));
+}
+
 std::unique_ptr<expression_unary>
 make_unary(expression_unary::kind kind, std::unique_ptr<expression> inner)
 {
     return std::make_unique<expression_unary>(kind, std::move(inner));
 }
 
-std::unique_ptr<expression_identifier> make_identifier(std::string name)
+std::unique_ptr<expression_identifier> make_identifier(symbol_table::symbol sym)
 {
-    return std::make_unique<expression_identifier>(std::move(name));
+    return std::make_unique<expression_identifier>(sym);
+}
+
+std::unique_ptr<expression_identifier> make_identifier(std::string_view name)
+{
+    return std::make_unique<expression_identifier>(name);
+}
+
+
+/**
+ * Appends `expr' to `out', in infix notation or, if `debug' is set, as
+ * the indented tree starting at column `offset'
+ *
+ * The tree is walked once with an explicit stack, appending straight to
+ * `out', so printing takes time linear in the output, allocates nothing
+ * per node and does not recurse however deep the expression is. An n-ary
+ * node prints as the right-nested chain of binary nodes it stands for.
+ */
+void print_expression(fmt::memory_buffer& out, const expression& expr, bool debug, long offset)
+{
+    struct frame
+    {
+        const expression* expr;
+        long offset;
+        std::size_t next;
+    };
+
+    const auto append = [&out](std::string_view text) { out.append(text); };
+    const auto repeat = [&out](char c, std::size_t count) {
+        const auto size = out.size();
+        out.resize(size + count);
+        std::fill_n(out.data() + size, count, c);
+    };
+    const auto is_binary = [](const expression& e) {
+        return e.type() == expression::type::BINARY;
+    };
+
+    std::vector<frame> work;
+    work.push_back({&expr, offset, 0});
+    while (!work.empty())
+    {
+        // Copied out, since pushing a child may move the stack
+        const auto top = work.back();
+        auto& next = work.back().next;
+
+        visit(
+            *top.expr,
+            overloaded{
+                [&](const expression_identifier& ident) {
+                    const auto& name = ident.name();
+                    if (debug)
+                    {
+                        repeat(' ', top.offset);
+                        append("(ID ");
+                        append(name);
+                        append(")");
+                    }
+                    else
+                    {
+                        append(name);
+                    }
+                    work.pop_back();
+                },
+                [&](const expression_unary& unary) {
+                    const auto& inner = unary.inner();
+                    if (top.next == 0)
+                    {
+                        next = 1;
+                        if (debug)
+                        {
+                            repeat(' ', top.offset);
+                            append("(NOT\n");
+                        }
+                        else
+                        {
+                            append(is_binary(inner) ? "!(" : "!");
+                        }
+                        work.push_back({&inner, top.offset + 2, 0});
+                    }
+                    else
+                    {
+                        if (debug || is_binary(inner))
+                            append(")");
+                        work.pop_back();
+                    }
+                },
+                [&](const expression_binary& bin) {
+                    const auto& operands = bin.operands();
+                    const auto last = operands.size() - 1;
+                    const auto i = top.next;
+
+                    if (debug)
+                    {
+                        const auto* op_str =
+                            bin.op() == expression_binary::kind::AND ? "AND" : "OR";
+                        if (i > 0 && i <= last)
+                            append("\n");
+
+                        if (i < last)
+                        {
+                            const auto sub_offset = top.offset + 2 * static_cast<long>(i);
+                            repeat(' ', sub_offset);
+                            append("(");
+                            append(op_str);
+                            append("\n");
+                            next = i + 1;
+                            work.push_back({operands[i].get(), sub_offset + 2, 0});
+                        }
+                        else if (i == last)
+                        {
+                            next = i + 1;
+                            work.push_back(
+                                {operands[i].get(), top.offset + 2 * static_cast<long>(last), 0});
+                        }
+                        else
+                        {
+                            repeat(')', last);
+                            work.pop_back();
+                        }
+                    }
+                    else
+                    {
+                        const auto* op_str =
+                            bin.op() == expression_binary::kind::AND ? " && " : " || ";
+                        if (i > 0)
+                        {
+                            if (is_binary(*operands[i - 1]))
+                                append(")");
+                            if (i <= last)
+                                append(op_str);
+                        }
+
+                        if (i <= last)
+                        {
+                            if (i > 0 && i < last)
+                                append("(");
+                            if (is_binary(*operands[i]))
+                                append("(");
+                            next = i + 1;
+                            work.push_back({operands[i].get(), 0, 0});
+                        }
+                        else
+                        {
+                            repeat(')', last - 1);
+                            work.pop_back();
+                        }
+                    }
+                },
+            });
+    }
 }
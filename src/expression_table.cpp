@@ -0,0 +1,152 @@
+#include "expression_table.hpp"
+
+#include <limits>
+#include <stdexcept>
+
+namespace
+{
+constexpr expression_table::id EMPTY = 0;
+constexpr std::size_t INITIAL_SLOTS = 64;
+
+std::uint64_t mix(std::uint64_t x) noexcept
+{
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9ULL;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return x;
+}
+
+std::uint64_t hash(std::uint32_t tag, expression_table::id first, expression_table::id second)
+{
+    return mix(
+        (static_cast<std::uint64_t>(first) << 32 | second)
+        ^ mix(static_cast<std::uint64_t>(tag) + 1));
+}
+} // namespace
+
+expression_table::expression_table() noexcept
+    : shards_()
+    , next_id_(EMPTY + 1)
+    , generation_(0)
+{
+}
+
+/**
+ * Interns the structure of a node
+ *
+ * Identifiers are interned by their symbol, inner nodes by the ids of
+ * their children. Two nodes with the same tag and operands always get
+ * the same id, and nodes with different structure never do, so comparing
+ * ids is equivalent to comparing whole trees. Each distinct structure is
+ * stored once, in one of several independently locked shards, so every
+ * call takes the lock of one shard.
+ *
+ * Ids are never reused until `clear'. Once every 32-bit id has been
+ * handed out, interning a new structure throws `std::length_error'
+ * rather than wrap around onto ids still in use.
+ *
+ * @param tag Node type and operator
+ * @param first Id of the first child, or the symbol of an identifier
+ * @param second Id of the second child, or 0 if there is none
+ * @return Id of the structure
+ */
+expression_table::id expression_table::intern(std::uint32_t tag, id first, id second)
+{
+    const auto h = hash(tag, first, second);
+    auto& sh = shards_[h % SHARDS];
+
+    const std::lock_guard lock(sh.mutex);
+
+    if (2 * (sh.used + 1) > sh.slots.size())
+        grow(sh);
+
+    const auto mask = sh.slots.size() - 1;
+    for (auto i = (h / SHARDS) & mask;; i = (i + 1) & mask)
+    {
+        auto& slot = sh.slots[i];
+        if (slot.value == EMPTY)
+        {
+            slot = {tag, first, second, next_id()};
+            sh.used++;
+            return slot.value;
+        }
+
+        if (slot.tag == tag && slot.first == first && slot.second == second)
+            return slot.value;
+    }
+}
+
+std::size_t expression_table::size() const noexcept
+{
+    return next_id_.load(std::memory_order_relaxed) - 1;
+}
+
+/**
+ * Returns the number of calls to `clear' so far
+ *
+ * Anything keyed on ids, such as `simplify_cache', must be dropped once
+ * the generation changes, since ids are handed out again from 1.
+ */
+std::uint64_t expression_table::generation() const noexcept
+{
+    return generation_.load(std::memory_order_acquire);
+}
+
+/**
+ * Forgets every interned structure
+ *
+ * Ids handed out before the call become meaningless, so no node may be
+ * alive, and no other thread may be interning, when this is called. The
+ * generation is bumped, so that caches keyed on ids can tell.
+ */
+void expression_table::clear() noexcept
+{
+    for (auto& sh : shards_)
+    {
+        sh.slots.clear();
+        sh.slots.shrink_to_fit();
+        sh.used = 0;
+    }
+
+    next_id_.store(EMPTY + 1, std::memory_order_relaxed);
+    generation_.fetch_add(1, std::memory_order_release);
+}
+
+expression_table& expression_table::instance() noexcept
+{
+    static expression_table table;
+    return table;
+}
+
+expression_table::id expression_table::next_id()
+{
+    auto value = next_id_.load(std::memory_order_relaxed);
+    do
+    {
+        if (value == std::numeric_limits<id>::max())
+            throw std::length_error("expression_table: out of ids");
+    } while (!next_id_.compare_exchange_weak(value, value + 1, std::memory_order_relaxed));
+
+    return value;
+}
+
+void expression_table::grow(shard& sh)
+{
+    std::vector<entry> slots(sh.slots.empty() ? INITIAL_SLOTS : 2 * sh.slots.size());
+    const auto mask = slots.size() - 1;
+
+    for (const auto& slot : sh.slots)
+    {
+        if (slot.value == EMPTY)
+            continue;
+
+        auto i = (hash(slot.tag, slot.first, slot.second) / SHARDS) & mask;
+        while (slots[i].value != EMPTY)
+            i = (i + 1) & mask;
+        slots[i] = slot;
+    }
+
+    sh.slots = std::move(slots);
+}
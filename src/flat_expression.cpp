@@ -0,0 +1,555 @@
+#include "flat_expression.hpp"
+
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace
+{
+using node_index = flat_expression::index;
+using op = flat_expression::op;
+
+constexpr node_index NONE = 0;
+
+op flat_op(expression_binary::kind kind)
+{
+    switch (kind)
+    {
+    case expression_binary::kind::AND:
+        return op::AND;
+
+    case expression_binary::kind::OR:
+        return op::OR;
+    }
+
+    assert(!"Invalid binary operator");
+    return op::AND;
+}
+
+expression_binary::kind binary_kind(op tag)
+{
+    assert(tag == op::AND || tag == op::OR);
+    return tag == op::AND ? expression_binary::kind::AND : expression_binary::kind::OR;
+}
+
+op flip(op tag)
+{
+    assert(tag == op::AND || tag == op::OR);
+    return tag == op::AND ? op::OR : op::AND;
+}
+
+/**
+ * Hash-consed DAG of simplified nodes
+ *
+ * Every node is created together with its simplified negation, so that
+ * structural equality is a comparison of indices and negating a node is
+ * a single lookup.
+ */
+class simplified_dag
+{
+public:
+    const std::vector<flat_expression::node>& nodes() const noexcept
+    {
+        return nodes_;
+    }
+
+    node_index identifier(symbol_table::symbol sym)
+    {
+        const auto [it, inserted] = identifiers_.try_emplace(sym, 0);
+        if (!inserted)
+            return it->second;
+
+        const auto ident = push(op::IDENTIFIER, sym, NONE);
+        const auto neg = push(op::NOT, ident, NONE);
+        negation_[ident] = neg;
+        negation_[neg] = ident;
+
+        it->second = ident;
+        return ident;
+    }
+
+    node_index binary(op tag, node_index left, node_index right)
+    {
+        auto& table = tag == op::AND ? ands_ : ors_;
+        const auto [it, inserted] = table.try_emplace(key(left, right), 0);
+        if (!inserted)
+            return it->second;
+
+        const auto bin = push(tag, left, right);
+        it->second = bin;
+
+        auto& neg_table = tag == op::AND ? ors_ : ands_;
+        const auto neg_left = negation_[left];
+        const auto neg_right = negation_[right];
+        const auto neg = push(flip(tag), neg_left, neg_right);
+        neg_table.emplace(key(neg_left, neg_right), neg);
+
+        negation_[bin] = neg;
+        negation_[neg] = bin;
+
+        return bin;
+    }
+
+    node_index negate(node_index idx) const
+    {
+        return negation_[idx];
+    }
+
+private:
+    std::vector<flat_expression::node> nodes_;
+    std::vector<node_index> negation_;
+
+    std::unordered_map<symbol_table::symbol, node_index> identifiers_;
+    std::unordered_map<std::uint64_t, node_index> ands_;
+    std::unordered_map<std::uint64_t, node_index> ors_;
+
+    static std::uint64_t key(node_index left, node_index right) noexcept
+    {
+        return static_cast<std::uint64_t>(left) << 32 | right;
+    }
+
+    node_index push(op tag, node_index left, node_index right)
+    {
+        nodes_.push_back({tag, left, right});
+        negation_.push_back(NONE);
+        return static_cast<node_index>(nodes_.size() - 1);
+    }
+};
+
+/**
+ * Lays out the tree rooted at `root' of a DAG in post-order
+ */
+flat_expression expand(const std::vector<flat_expression::node>& dag, node_index root)
+{
+    flat_expression flat;
+
+    std::vector<std::pair<node_index, bool>> work = {{root, false}};
+    std::vector<node_index> done;
+
+    while (!work.empty())
+    {
+        const auto [idx, expanded] = work.back();
+        work.pop_back();
+
+        const auto& n = dag[idx];
+        if (!expanded)
+        {
+            work.emplace_back(idx, true);
+            switch (n.tag)
+            {
+            case op::IDENTIFIER:
+                break;
+
+            case op::NOT:
+                work.emplace_back(n.left, false);
+                break;
+
+            case op::AND:
+            case op::OR:
+                work.emplace_back(n.right, false);
+                work.emplace_back(n.left, false);
+                break;
+            }
+            continue;
+        }
+
+        switch (n.tag)
+        {
+        case op::IDENTIFIER:
+            done.push_back(flat.push_identifier(n.left));
+            break;
+
+        case op::NOT:
+            done.back() = flat.push_unary(done.back());
+            break;
+
+        case op::AND:
+        case op::OR:
+        {
+            const auto right = done.back();
+            done.pop_back();
+            done.back() = flat.push_binary(n.tag, done.back(), right);
+            break;
+        }
+        }
+    }
+
+    return flat;
+}
+} // namespace
+
+const std::vector<flat_expression::node>& flat_expression::nodes() const noexcept
+{
+    return nodes_;
+}
+
+flat_expression::index flat_expression::root() const noexcept
+{
+    assert(!nodes_.empty());
+    return static_cast<node_index>(nodes_.size() - 1);
+}
+
+std::size_t flat_expression::size() const noexcept
+{
+    return nodes_.size();
+}
+
+bool flat_expression::empty() const noexcept
+{
+    return nodes_.empty();
+}
+
+flat_expression::index flat_expression::push_identifier(symbol_table::symbol sym)
+{
+    nodes_.push_back({op::IDENTIFIER, sym, NONE});
+    return root();
+}
+
+flat_expression::index flat_expression::push_unary(index inner)
+{
+    assert(inner < nodes_.size());
+    nodes_.push_back({op::NOT, inner, NONE});
+    return root();
+}
+
+flat_expression::index flat_expression::push_binary(op tag, index left, index right)
+{
+    assert(tag == op::AND || tag == op::OR);
+    assert(left < nodes_.size() && right < nodes_.size());
+    nodes_.push_back({tag, left, right});
+    return root();
+}
+
+void flat_expression::reserve(std::size_t size)
+{
+    nodes_.reserve(size);
+}
+
+void flat_expression::clear() noexcept
+{
+    nodes_.clear();
+}
+
+
+/**
+ * Compares two flat expressions structurally
+ *
+ * The post-order layout of a tree is unique, so this is a single linear
+ * comparison of the node arrays.
+ */
+bool operator==(const flat_expression& l, const flat_expression& r)
+{
+    const auto& l_nodes = l.nodes();
+    const auto& r_nodes = r.nodes();
+
+    if (l_nodes.size() != r_nodes.size())
+        return false;
+
+    for (std::size_t i = 0; i < l_nodes.size(); i++)
+    {
+        const auto& ln = l_nodes[i];
+        const auto& rn = r_nodes[i];
+        if (ln.tag != rn.tag || ln.left != rn.left || ln.right != rn.right)
+            return false;
+    }
+
+    return true;
+}
+
+bool operator!=(const flat_expression& l, const flat_expression& r)
+{
+    return !(l == r);
+}
+
+
+/**
+ * Converts an expression tree into its flat post-order representation
+ *
+ * @param expr The expression to convert
+ * @return The flat expression
+ */
+flat_expression flatten(const expression& expr)
+{
+    flat_expression flat;
+
+    std::vector<std::pair<const expression*, bool>> work = {{&expr, false}};
+    std::vector<node_index> done;
+
+    while (!work.empty())
+    {
+        const auto* e = work.back().first;
+        const auto expanded = work.back().second;
+        work.pop_back();
+
+        visit(
+            *e,
+            overloaded{
+                [&](const expression_identifier& ident) {
+                    done.push_back(flat.push_identifier(ident.symbol()));
+                },
+                [&](const expression_unary& unary) {
+                    if (!expanded)
+                    {
+                        work.emplace_back(e, true);
+                        work.emplace_back(&unary.inner(), false);
+                    }
+                    else
+                    {
+                        done.back() = flat.push_unary(done.back());
+                    }
+                },
+                [&](const expression_binary& binary) {
+                    const auto& operands = binary.operands();
+                    if (!expanded)
+                    {
+                        work.emplace_back(e, true);
+                        for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                            work.emplace_back(it->get(), false);
+                    }
+                    else
+                    {
+                        // Lay the node out as the right-nested chain it stands for
+                        const auto tag = flat_op(binary.op());
+                        auto right = done.back();
+                        done.pop_back();
+                        for (std::size_t i = 1; i < operands.size(); i++)
+                        {
+                            right = flat.push_binary(tag, done.back(), right);
+                            done.pop_back();
+                        }
+                        done.push_back(right);
+                    }
+                },
+            });
+    }
+
+    return flat;
+}
+
+/**
+ * Converts a flat expression back into an expression tree
+ *
+ * Nodes may share operands, as `push_unary' and `push_binary' accept any
+ * earlier index. The last use of a node takes its tree, and earlier uses
+ * take a clone of it.
+ *
+ * @param flat The flat expression to convert
+ * @return Owning reference to the expression tree
+ */
+std::unique_ptr<expression> unflatten(const flat_expression& flat)
+{
+    const auto& nodes = flat.nodes();
+    std::vector<std::unique_ptr<expression>> built(nodes.size());
+
+    std::vector<std::size_t> uses(nodes.size(), 0);
+    for (const auto& n : nodes)
+    {
+        if (n.tag == op::IDENTIFIER)
+            continue;
+
+        uses[n.left]++;
+        if (n.tag != op::NOT)
+            uses[n.right]++;
+    }
+
+    // Binary nodes that are the only use of the right operand of the same
+    // operator are gathered into the node at the head of their chain
+    std::vector<bool> in_chain(nodes.size(), false);
+    for (const auto& n : nodes)
+        if ((n.tag == op::AND || n.tag == op::OR) && nodes[n.right].tag == n.tag
+            && uses[n.right] == 1)
+            in_chain[n.right] = true;
+
+    const auto take = [&](node_index idx) {
+        return --uses[idx] == 0 ? std::move(built[idx]) : built[idx]->clone();
+    };
+
+    for (std::size_t i = 0; i < nodes.size(); i++)
+    {
+        const auto& n = nodes[i];
+        switch (n.tag)
+        {
+        case op::IDENTIFIER:
+            built[i] = make_identifier(n.left);
+            break;
+
+        case op::NOT:
+            built[i] = make_unary(expression_unary::kind::NOT, take(n.left));
+            break;
+
+        case op::AND:
+        case op::OR:
+        {
+            if (in_chain[i])
+                break;
+
+            expression_binary::operand_list operands;
+            auto link = static_cast<node_index>(i);
+            for (;;)
+            {
+                operands.push_back(take(nodes[link].left));
+                link = nodes[link].right;
+                if (!in_chain[link])
+                    break;
+            }
+            operands.push_back(take(link));
+
+            built[i] = make_binary(binary_kind(n.tag), std::move(operands));
+            break;
+        }
+        }
+    }
+
+    return std::move(built[flat.root()]);
+}
+
+/**
+ * Simplifies a flat expression
+ *
+ * Implements the same rewrite rules as `simplify(const expression&)' in a
+ * single linear scan over the post-order nodes. Simplified nodes are
+ * hash-consed together with their negations, so that the X [AND/OR] X
+ * rule is an index comparison and a NOT costs a lookup, and the result is
+ * laid out in post-order once at the end.
+ *
+ * @param flat The flat expression to simplify
+ * @return The simplified flat expression
+ */
+flat_expression simplify(const flat_expression& flat)
+{
+    const auto& nodes = flat.nodes();
+
+    simplified_dag dag;
+    std::vector<node_index> simplified(nodes.size());
+
+    for (std::size_t i = 0; i < nodes.size(); i++)
+    {
+        const auto& n = nodes[i];
+        switch (n.tag)
+        {
+        case op::IDENTIFIER:
+            simplified[i] = dag.identifier(n.left);
+            break;
+
+        case op::NOT:
+            simplified[i] = dag.negate(simplified[n.left]);
+            break;
+
+        case op::AND:
+        case op::OR:
+        {
+            const auto left = simplified[n.left];
+            const auto right = simplified[n.right];
+            simplified[i] = left == right ? left : dag.binary(n.tag, left, right);
+            break;
+        }
+        }
+    }
+
+    return expand(dag.nodes(), simplified[flat.root()]);
+}
+
+
+/**
+ * Appends `flat' to `out', in the same format as `print_expression'
+ *
+ * The tree is walked once with an explicit stack, appending straight to
+ * `out', so printing is linear in the size of the expression.
+ *
+ * @param out The buffer to append to
+ * @param flat The flat expression to print
+ * @param debug Whether to use the `:d' debug format
+ * @param offset Indentation of the debug format
+ */
+void print_flat(fmt::memory_buffer& out, const flat_expression& flat, bool debug, long offset)
+{
+    struct item
+    {
+        std::string_view text;
+        node_index idx;
+        long offset;
+    };
+
+    const auto& nodes = flat.nodes();
+    const auto& symbols = symbol_table::instance();
+
+    const auto append = [&out](std::string_view text) {
+        out.append(text.data(), text.data() + text.size());
+    };
+
+    std::vector<item> work = {{{}, flat.root(), offset}};
+    while (!work.empty())
+    {
+        const auto it = work.back();
+        work.pop_back();
+
+        if (!it.text.empty())
+        {
+            append(it.text);
+            continue;
+        }
+
+        const auto& n = nodes[it.idx];
+        const auto child = [&](node_index idx, long child_offset) {
+            if (!debug && nodes[idx].tag != op::IDENTIFIER && nodes[idx].tag != op::NOT)
+            {
+                work.push_back({")", 0, 0});
+                work.push_back({{}, idx, child_offset});
+                work.push_back({"(", 0, 0});
+            }
+            else
+            {
+                work.push_back({{}, idx, child_offset});
+            }
+        };
+
+        if (debug)
+        {
+            out.resize(out.size() + it.offset);
+            std::fill(out.end() - it.offset, out.end(), ' ');
+        }
+
+        switch (n.tag)
+        {
+        case op::IDENTIFIER:
+            if (debug)
+                append("(ID ");
+            append(symbols.name(n.left));
+            if (debug)
+                append(")");
+            break;
+
+        case op::NOT:
+            if (debug)
+            {
+                append("(NOT\n");
+                work.push_back({")", 0, 0});
+                child(n.left, it.offset + 2);
+            }
+            else
+            {
+                append("!");
+                child(n.left, 0);
+            }
+            break;
+
+        case op::AND:
+        case op::OR:
+            if (debug)
+            {
+                append(n.tag == op::AND ? "(AND\n" : "(OR\n");
+                work.push_back({")", 0, 0});
+                child(n.right, it.offset + 2);
+                work.push_back({"\n", 0, 0});
+                child(n.left, it.offset + 2);
+            }
+            else
+            {
+                child(n.right, 0);
+                work.push_back({n.tag == op::AND ? " && " : " || ", 0, 0});
+                child(n.left, 0);
+            }
+            break;
+        }
+    }
+}
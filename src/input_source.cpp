@@ -0,0 +1,256 @@
+#include "input_source.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#include <iostream>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+/**
+ * Returns whether reading the input failed
+ *
+ * A source that failed returns the kept bytes only from then on, as if
+ * the input had ended, so this tells an error from the end of the input.
+ */
+bool input_source::failed() const noexcept
+{
+    return false;
+}
+
+
+input_string::input_string(std::string_view text) noexcept
+    : input_source()
+    , text_(text)
+    , consumed_(false)
+{
+}
+
+/**
+ * Returns the whole string on the first call, and only the kept bytes
+ * afterwards
+ *
+ * @see input_buffered::next
+ */
+std::string_view input_string::next(std::size_t keep)
+{
+    if (consumed_)
+        return text_.substr(text_.size() - keep);
+
+    consumed_ = true;
+    return text_;
+}
+
+
+input_mmap::input_mmap(void* data, std::size_t size) noexcept
+    : input_source()
+    , data_(data)
+    , size_(size)
+    , consumed_(false)
+{
+}
+
+input_mmap::~input_mmap()
+{
+    if (data_ != nullptr)
+        munmap(data_, size_);
+}
+
+/**
+ * Returns the whole mapping on the first call, and only the kept bytes
+ * afterwards
+ *
+ * @see input_buffered::next
+ */
+std::string_view input_mmap::next(std::size_t keep)
+{
+    const auto text = std::string_view(static_cast<const char*>(data_), size_);
+    if (consumed_)
+        return text.substr(text.size() - keep);
+
+    consumed_ = true;
+    return text;
+}
+
+
+input_buffered::input_buffered(std::istream& stream, std::size_t block_size)
+    : input_source()
+    , owned_stream_(nullptr)
+    , stream_(stream)
+    , block_size_(block_size)
+    , buffer_()
+    , size_(0)
+    , failed_(false)
+{
+}
+
+input_buffered::input_buffered(std::unique_ptr<std::istream> stream, std::size_t block_size)
+    : input_source()
+    , owned_stream_(std::move(stream))
+    , stream_(*owned_stream_)
+    , block_size_(block_size)
+    , buffer_()
+    , size_(0)
+    , failed_(false)
+{
+}
+
+input_buffered::~input_buffered() = default;
+
+/**
+ * Returns the next contiguous range of the input
+ *
+ * The returned range starts with the last `keep' bytes of the previous
+ * range, so that a token spanning two reads stays contiguous. Once the
+ * input is exhausted, the returned range holds only those `keep' bytes.
+ *
+ * The kept bytes are moved to the front of the buffer and the rest of it
+ * is filled with a single large read, growing the buffer when a single
+ * token does not fit in one block. A stream error is reported once, and
+ * ends the input.
+ *
+ * @param keep Number of bytes at the end of the previous range to keep
+ * @return View of the input, valid until the next call
+ */
+std::string_view input_buffered::next(std::size_t keep)
+{
+    if (keep > 0)
+        std::memmove(buffer_.data(), buffer_.data() + size_ - keep, keep);
+
+    if (buffer_.size() < keep + block_size_)
+        buffer_.resize(keep + block_size_);
+
+    stream_.read(buffer_.data() + keep, static_cast<std::streamsize>(block_size_));
+    size_ = keep + static_cast<std::size_t>(stream_.gcount());
+
+    if (stream_.bad() && !failed_)
+    {
+        std::cerr << "Error: Cannot read input\n";
+        failed_ = true;
+    }
+
+    return std::string_view(buffer_.data(), size_);
+}
+
+bool input_buffered::failed() const noexcept
+{
+    return failed_;
+}
+
+
+input_fd::input_fd(int fd, std::string name, bool owned, std::size_t block_size)
+    : input_source()
+    , fd_(fd)
+    , name_(std::move(name))
+    , owned_(owned)
+    , block_size_(block_size)
+    , buffer_()
+    , size_(0)
+    , failed_(false)
+{
+}
+
+input_fd::~input_fd()
+{
+    if (owned_)
+        close(fd_);
+}
+
+/**
+ * Returns the next contiguous range of the input
+ *
+ * Works like `input_buffered::next', but reads the descriptor directly.
+ * A single read is made, so a pipe or terminal hands over what it has
+ * without waiting for a whole block. A read error is reported once, and
+ * ends the input.
+ *
+ * @param keep Number of bytes at the end of the previous range to keep
+ * @return View of the input, valid until the next call
+ */
+std::string_view input_fd::next(std::size_t keep)
+{
+    if (keep > 0)
+        std::memmove(buffer_.data(), buffer_.data() + size_ - keep, keep);
+
+    if (buffer_.size() < keep + block_size_)
+        buffer_.resize(keep + block_size_);
+
+    size_ = keep;
+    if (failed_)
+        return std::string_view(buffer_.data(), size_);
+
+    auto count = read(fd_, buffer_.data() + keep, block_size_);
+    while (count < 0 && errno == EINTR)
+        count = read(fd_, buffer_.data() + keep, block_size_);
+
+    if (count < 0)
+    {
+        std::cerr << fmt::format("{}: Error: {}\n", name_, std::strerror(errno));
+        failed_ = true;
+    }
+    else
+        size_ += static_cast<std::size_t>(count);
+
+    return std::string_view(buffer_.data(), size_);
+}
+
+bool input_fd::failed() const noexcept
+{
+    return failed_;
+}
+
+
+/**
+ * Opens the file at `path' with the most suitable input source
+ *
+ * Regular files are memory mapped. Everything else (pipes, terminals,
+ * character devices) is read through the descriptor that was opened,
+ * since a FIFO cannot be opened a second time without losing its writer.
+ * `-' stands for the standard input.
+ *
+ * @param path Path of the file to open
+ * @return Owning reference to the input source, or `nullptr' on error
+ */
+std::unique_ptr<input_source> open_input(const char* path)
+{
+    if (std::strcmp(path, "-") == 0)
+        return std::make_unique<input_fd>(STDIN_FILENO, "stdin", false);
+
+    const auto fd = open(path, O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << fmt::format("{}: Error: {}\n", path, std::strerror(errno));
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
+    {
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size == 0)
+        {
+            close(fd);
+            return std::make_unique<input_string>(std::string_view());
+        }
+
+        auto* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data == MAP_FAILED)
+        {
+            std::cerr << fmt::format("{}: Error: {}\n", path, std::strerror(errno));
+            return nullptr;
+        }
+
+        madvise(data, size, MADV_SEQUENTIAL);
+        return std::make_unique<input_mmap>(data, size);
+    }
+
+    return std::make_unique<input_fd>(fd, path, true);
+}
@@ -1,237 +1,142 @@
 #include "lexer.hpp"
 
-#include <climits>
-
-#include <array>
 #include <iostream>
-#include <limits>
-#include <string_view>
+
+#include "lexer_table.hpp"
+#include "scanner.hpp"
 
 namespace
 {
-constexpr std::size_t cpow(std::size_t base, std::size_t exp)
+position step(const position& pos, char ch)
 {
-    if (exp == 1)
-        return base;
+    if (ch == '\n')
+    {
+        return position(pos.line() + 1, 1);
+    }
     else
-        return base * cpow(base, exp - 1);
-}
-
-constexpr auto LEN = cpow(2, CHAR_BIT);
-using table = std::array<std::array<lexer::state, LEN>, LEN>;
-
-constexpr auto END = static_cast<unsigned char>(EOF);
-
-constexpr std::string_view ALPHANUM_START = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_";
-constexpr std::string_view ALPHANUM_REST
-    = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_0123456789";
-constexpr std::string_view WHITESPACE = " \t\v\r\n";
-
-constexpr void init_alphanum(table& tbl)
-{
-    for (const auto& s : ALPHANUM_START)
-        tbl['\0'][s] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-
-    for (const auto& s : ALPHANUM_START)
-        for (const auto& r : ALPHANUM_REST)
-            tbl[s][r] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-    for (const auto& r1 : ALPHANUM_REST)
-        for (const auto& r2 : ALPHANUM_REST)
-            tbl[r1][r2] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-    for (const auto& r : ALPHANUM_REST)
     {
-        for (const auto& w : WHITESPACE)
-            tbl[r][w] = {lexer::table_state::ACCEPT, lexer::accept_state::IDENTIFIER};
-
-        tbl[r]['&'] = {lexer::table_state::ACCEPT, lexer::accept_state::IDENTIFIER};
-        tbl[r]['|'] = {lexer::table_state::ACCEPT, lexer::accept_state::IDENTIFIER};
-        tbl[r]['('] = {lexer::table_state::ACCEPT, lexer::accept_state::IDENTIFIER};
-        tbl[r][')'] = {lexer::table_state::ACCEPT, lexer::accept_state::IDENTIFIER};
-        tbl[r]['!'] = {lexer::table_state::ACCEPT, lexer::accept_state::IDENTIFIER};
-
-        tbl[r][END] = {lexer::table_state::ACCEPT, lexer::accept_state::IDENTIFIER};
+        return position(pos.line(), pos.column() + 1);
     }
 }
+} // namespace
 
-constexpr void init_lparen(table& tbl)
-{
-    tbl['\0']['('] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-
-    for (const auto& r : ALPHANUM_START)
-        tbl['('][r] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    for (const auto& w : WHITESPACE)
-        tbl['('][w] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['(']['&'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['(']['|'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['(']['('] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['('][')'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['(']['!'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['('][END] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-}
-
-constexpr void init_rparen(table& tbl)
-{
-    tbl['\0'][')'] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-
-    for (const auto& r : ALPHANUM_START)
-        tbl[')'][r] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    for (const auto& w : WHITESPACE)
-        tbl[')'][w] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl[')']['&'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl[')']['|'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl[')']['('] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl[')'][')'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl[')']['!'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl[')'][END] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-}
-
-constexpr void init_amper(table& tbl)
-{
-    tbl['\0']['&'] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-
-    for (const auto& r : ALPHANUM_START)
-        tbl['&'][r] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    for (const auto& w : WHITESPACE)
-        tbl['&'][w] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['&']['&'] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-    tbl['&']['|'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['&']['('] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['&'][')'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['&']['!'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['&'][END] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-}
-
-constexpr void init_bar(table& tbl)
+lexer::lexer(std::istream& stream)
+    : owned_source_(std::make_unique<input_buffered>(stream))
+    , source_(*owned_source_)
+    , buffer_()
+    , offset_(0)
+    , token_start_(0)
+    , current_pos(1, 1)
+    , newline_separators_(false)
+    , semicolon_separators_(false)
+    , diagnostics_(true)
+    , prev_char(read())
 {
-    tbl['\0']['|'] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-
-    for (const auto& r : ALPHANUM_START)
-        tbl['|'][r] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    for (const auto& w : WHITESPACE)
-        tbl['|'][w] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['|']['&'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['|']['|'] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-    tbl['|']['('] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['|'][')'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['|']['!'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['|'][END] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
 }
 
-constexpr void init_exclam(table& tbl)
+lexer::lexer(input_source& source)
+    : owned_source_(nullptr)
+    , source_(source)
+    , buffer_()
+    , offset_(0)
+    , token_start_(0)
+    , current_pos(1, 1)
+    , newline_separators_(false)
+    , semicolon_separators_(false)
+    , diagnostics_(true)
+    , prev_char(read())
 {
-    tbl['\0']['!'] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-
-    for (const auto& r : ALPHANUM_START)
-        tbl['!'][r] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    for (const auto& w : WHITESPACE)
-        tbl['!'][w] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['!']['&'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['!']['|'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['!']['('] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['!'][')'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-    tbl['!']['!'] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
-
-    tbl['!'][END] = {lexer::table_state::ACCEPT, lexer::accept_state::OPERATOR};
 }
 
-constexpr void init_whitespace(table& tbl)
+token lexer::next_token()
 {
-    for (const auto& w : WHITESPACE)
-        tbl['\0'][w] = {lexer::table_state::CONTINUE, lexer::accept_state::NONE};
-    for (const auto& w : WHITESPACE)
+    for (;;)
     {
-        for (const auto& r : ALPHANUM_START)
-            tbl[w][r] = {lexer::table_state::ACCEPT, lexer::accept_state::WHITESPACE};
-
-        tbl[w]['&'] = {lexer::table_state::ACCEPT, lexer::accept_state::WHITESPACE};
-        tbl[w]['|'] = {lexer::table_state::ACCEPT, lexer::accept_state::WHITESPACE};
-        tbl[w]['('] = {lexer::table_state::ACCEPT, lexer::accept_state::WHITESPACE};
-        tbl[w][')'] = {lexer::table_state::ACCEPT, lexer::accept_state::WHITESPACE};
-        tbl[w]['!'] = {lexer::table_state::ACCEPT, lexer::accept_state::WHITESPACE};
-
-        tbl[w][END] = {lexer::table_state::ACCEPT, lexer::accept_state::WHITESPACE};
+        if (auto tok = scan())
+            return *tok;
     }
 }
 
-constexpr table create_table()
+/**
+ * Makes a line break end the expression on it, as `;' does once enabled
+ *
+ * Whitespace that contains a line break is then reported as a single
+ * separator token instead of being skipped.
+ *
+ * @param enabled Whether line breaks separate expressions
+ */
+void lexer::set_newline_separators(bool enabled) noexcept
 {
-    table tbl = {};
-    for (auto& row : tbl)
-        for (auto& col : row)
-            col = {lexer::table_state::REJECT, lexer::accept_state::NONE};
-
-    init_alphanum(tbl);
-    init_lparen(tbl);
-    init_rparen(tbl);
-    init_amper(tbl);
-    init_bar(tbl);
-    init_exclam(tbl);
-    init_whitespace(tbl);
-
-    return tbl;
+    newline_separators_ = enabled;
 }
 
-constexpr table tbl = create_table();
-
-position step(const position& pos, char ch)
+/**
+ * Makes `;' end the expression before it
+ *
+ * Otherwise `;' is an invalid character, as it is in the interactive
+ * mode.
+ *
+ * @param enabled Whether `;' separates expressions
+ */
+void lexer::set_semicolon_separators(bool enabled) noexcept
 {
-    if (ch == '\n')
-    {
-        return position(pos.line() + 1, 1);
-    }
-    else
-    {
-        return position(pos.line(), pos.column() + 1);
-    }
+    semicolon_separators_ = enabled;
 }
-} // namespace
 
-lexer::lexer(std::istream& stream)
-    : stream_(stream)
-    , current_pos(1, 1)
-    , prev_char(read())
+/**
+ * Turns the messages printed on `std::cerr' for invalid input on or off
+ *
+ * The error token is returned either way.
+ *
+ * @param enabled Whether to print diagnostics
+ */
+void lexer::set_diagnostics(bool enabled) noexcept
 {
+    diagnostics_ = enabled;
 }
 
-std::unique_ptr<token> lexer::next_token()
+/**
+ * Scans a single token, or a single run of whitespace
+ *
+ * @return The token, or nothing if whitespace was skipped
+ */
+std::optional<token> lexer::scan()
 {
     position start_pos = current_pos;
 
-    std::string text;
-    text += prev_char;
+    const auto class_of = [this](char ch) {
+        const auto cls = classify(ch);
+        return cls == char_class::SEMICOLON && !semicolon_separators_ ? char_class::OTHER : cls;
+    };
+
+    token_start_ = offset_ - 1;
+    std::size_t length = 1;
 
     for (;;)
     {
         char ch = prev_char;
         if (ch == static_cast<char>(EOF))
         {
-            return std::make_unique<token_end>(location(current_pos, current_pos));
+            return make_end_token(location(current_pos, current_pos));
         }
 
-        const auto& cur_row = tbl[ch];
+        const auto prev_class = class_of(ch);
 
         ch = read();
 
-        const auto cur_col = cur_row[ch];
+        const auto cur_col = transition(prev_class, class_of(ch));
 
         switch (cur_col.tbl)
         {
         case table_state::REJECT:
-            std::cerr << fmt::format(
-                "{}: Error: Character `{0}' (0x{0:x} cannot follow `{1}' (0x{1:x}\n",
-                current_pos,
-                ch,
-                text);
-            return std::make_unique<token_error>(location(current_pos, current_pos));
+            if (diagnostics_)
+                std::cerr << fmt::format(
+                    "{}: Error: Character `{}' (0x{:x}) cannot follow `{}'\n",
+                    current_pos,
+                    ch,
+                    static_cast<unsigned char>(ch),
+                    buffer_.substr(token_start_, length));
+            return make_error_token(location(current_pos, current_pos));
 
         case table_state::ACCEPT:
         {
@@ -239,44 +144,51 @@ std::unique_ptr<token> lexer::next_token()
             current_pos = step(current_pos, ch);
             prev_char = ch;
 
+            const auto loc = location(start_pos, prev_pos);
+            const auto text = buffer_.substr(token_start_, length);
+
             switch (cur_col.acc)
             {
             case accept_state::WHITESPACE:
-                return next_token();
+                if (newline_separators_ && text.find('\n') != std::string_view::npos)
+                    return make_separator_token(loc, text);
+                return std::nullopt;
+
+            case accept_state::SEPARATOR:
+                return make_separator_token(loc, text);
 
             case accept_state::OPERATOR:
             {
-                const auto loc = location(start_pos, prev_pos);
-
                 if (text == "!")
                 {
-                    return std::make_unique<token_operator>(loc, token_operator::kind::EXCLAM);
+                    return make_operator_token(loc, text, token::kind::EXCLAM);
                 }
                 else if (text == "(")
                 {
-                    return std::make_unique<token_operator>(loc, token_operator::kind::LPAREN);
+                    return make_operator_token(loc, text, token::kind::LPAREN);
                 }
                 else if (text == ")")
                 {
-                    return std::make_unique<token_operator>(loc, token_operator::kind::RPAREN);
+                    return make_operator_token(loc, text, token::kind::RPAREN);
                 }
                 else if (text == "&&")
                 {
-                    return std::make_unique<token_operator>(loc, token_operator::kind::AMPERAMPER);
+                    return make_operator_token(loc, text, token::kind::AMPERAMPER);
                 }
                 else if (text == "||")
                 {
-                    return std::make_unique<token_operator>(loc, token_operator::kind::PIPEPIPE);
+                    return make_operator_token(loc, text, token::kind::PIPEPIPE);
                 }
                 else
                 {
-                    std::cerr << fmt::format("Invalid operator `{}'\n", text);
-                    return std::make_unique<token_error>(loc);
+                    if (diagnostics_)
+                        std::cerr << fmt::format("Invalid operator `{}'\n", text);
+                    return make_error_token(loc);
                 }
             }
 
             case accept_state::IDENTIFIER:
-                return std::make_unique<token_identifier>(location(start_pos, prev_pos), text);
+                return make_identifier_token(loc, text);
 
             case accept_state::NONE:
                 assert(!"Impossible accept state");
@@ -284,17 +196,63 @@ std::unique_ptr<token> lexer::next_token()
         }
 
         case table_state::CONTINUE:
+        {
             prev_char = ch;
-            text += ch;
+            length++;
+
+            // Identifier and whitespace characters only ever continue a run
+            // of their own class, so the rest of the run is skipped at once
+            const auto rest = buffer_.substr(offset_);
+            std::size_t run = 0;
+            switch (classify(ch))
+            {
+            case char_class::LETTER:
+            case char_class::DIGIT:
+                run = scan_identifier(rest);
+                break;
+
+            case char_class::WHITESPACE:
+                run = scan_whitespace(rest);
+                break;
+
+            default:
+                break;
+            }
+
+            if (run > 0)
+            {
+                offset_ += run;
+                length += run;
+                prev_char = buffer_[offset_ - 1];
+            }
             break;
         }
+        }
     }
 }
 
+/**
+ * Reads the next character of the input
+ *
+ * When the current range is exhausted, the characters of the token being
+ * scanned are carried over to the front of the next range, so that the
+ * text of a token is always one contiguous view.
+ *
+ * @return The next character, or EOF
+ */
 char lexer::read()
 {
-    char ch;
-    if (!stream_.read(&ch, 1))
-        return EOF;
-    return ch;
+    if (offset_ == buffer_.size())
+    {
+        const auto keep = buffer_.size() - token_start_;
+
+        buffer_ = source_.next(keep);
+        offset_ = keep;
+        token_start_ = 0;
+
+        if (buffer_.size() == keep)
+            return EOF;
+    }
+
+    return buffer_[offset_++];
 }
@@ -1,32 +1,98 @@
-#include <fstream>
+#include <charconv>
 #include <iostream>
+#include <string_view>
 
+#include "arena.hpp"
+#include "batch.hpp"
+#include "equivalence.hpp"
+#include "input_source.hpp"
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "simplifier.hpp"
 
 int main(int argc, char** argv)
 {
-    std::ifstream in(argv[1]);
+    bool verify = false;
+    bool batch = false;
+    std::size_t jobs = 1;
+    const char* path = "-";
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::string_view(argv[i]) == "--verify")
+            verify = true;
+        else if (std::string_view(argv[i]) == "--batch")
+            batch = true;
+        else if (std::string_view(argv[i]) == "-j")
+        {
+            const std::string_view value = i + 1 < argc ? argv[++i] : "";
+            const auto last = value.data() + value.size();
+            const auto [end, error] = std::from_chars(value.data(), last, jobs);
+            if (value.empty() || error != std::errc() || end != last || jobs == 0)
+            {
+                std::cerr << fmt::format("Error: Invalid number of jobs `{}'\n", value);
+                return 1;
+            }
+        }
+        else
+            path = argv[i];
+    }
 
-    lexer lex(in);
-    parser par(lex);
+    if (jobs > 1 && !batch)
+    {
+        std::cerr << "Error: -j requires --batch\n";
+        return 1;
+    }
 
-    for (;;)
+    const auto in = open_input(path);
+    if (in == nullptr)
+        return 1;
+
+    if (batch)
     {
-        const auto expr = par.parse_expression();
+        const auto result = run_batch(*in, std::cout, verify, jobs);
+        if (in->failed())
+            return 1;
+
+        return result.errors == 0 && result.failures == 0 ? 0 : 2;
+    }
+
+    expression_arena arena;
+
+    lexer lex(*in);
+    parser par(lex, arena);
+
+    std::size_t failures = 0;
+    for (std::size_t index = 1;; index++)
+    {
+        auto expr = par.parse_expression();
         if (expr == nullptr)
-            return 0;
+        {
+            if (in->failed())
+                return 1;
+
+            return failures == 0 ? 0 : 2;
+        }
 
         std::cout << "Loaded expression:" << std::endl;
         std::cout << fmt::format("{0:d}\n{0}", *expr) << std::endl;
 
         std::cout << std::endl;
 
-        auto negated = make_unary(expression_unary::kind::NOT, simplify(*expr));
-        auto final = make_unary(expression_unary::kind::NOT, simplify(*negated));
+        const arena_scope scope(arena);
+        auto nnf = verify ? to_nnf(*expr, true) : to_nnf(std::move(expr), true);
+        auto final = make_unary(expression_unary::kind::NOT, std::move(nnf));
 
         std::cout << "Demorganized expression:" << std::endl;
         std::cout << fmt::format("{0:d}\n{0}", *final) << std::endl;
+
+        if (verify)
+        {
+            const auto result = check_equivalence(*expr, *final);
+            if (result.status != equivalence_status::EQUIVALENT)
+            {
+                report_verification(index, result);
+                failures++;
+            }
+        }
     }
 }
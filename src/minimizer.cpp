@@ -0,0 +1,1024 @@
+#include "minimizer.hpp"
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "simplifier.hpp"
+#include "symbol_table.hpp"
+
+namespace
+{
+using word = std::uint64_t;
+
+// A cube gives every variable a field of two bits: bit 0 is set if the
+// variable may be false and bit 1 if it may be true. 01 is a negative
+// literal, 10 a positive literal and 11 a variable the cube does not
+// depend on, so the fields past the last variable are all 11. A field of
+// 00 makes the cube empty.
+constexpr std::size_t FIELDS_PER_WORD = 32;
+constexpr word LOW_BITS = 0x5555555555555555;
+constexpr word ALL_BITS = ~word(0);
+
+/**
+ * Returns the low bit of every field of `w' that holds a literal
+ */
+word literals(word w) noexcept
+{
+    return ~(w & (w >> 1)) & LOW_BITS;
+}
+
+/**
+ * Returns the low bit of every field of `w' that holds a positive literal
+ */
+word positive_literals(word w) noexcept
+{
+    return (w >> 1) & ~w & LOW_BITS;
+}
+
+/**
+ * Returns the low bit of every field of `w' that holds a negative literal
+ */
+word negative_literals(word w) noexcept
+{
+    return w & ~(w >> 1) & LOW_BITS;
+}
+
+std::size_t field_variable(std::size_t w, word bit) noexcept
+{
+    return w * FIELDS_PER_WORD + static_cast<std::size_t>(__builtin_ctzll(bit)) / 2;
+}
+
+word field_mask(std::size_t var) noexcept
+{
+    return word(3) << (2 * (var % FIELDS_PER_WORD));
+}
+
+/**
+ * A list of cubes of `width' words each, stored back to back
+ */
+class cover final
+{
+public:
+    explicit cover(std::size_t width)
+        : width_(width)
+        , words_()
+    {
+    }
+
+    [[nodiscard]] std::size_t width() const noexcept
+    {
+        return width_;
+    }
+
+    [[nodiscard]] std::size_t size() const noexcept
+    {
+        return words_.size() / width_;
+    }
+
+    [[nodiscard]] word* cube(std::size_t i) noexcept
+    {
+        return words_.data() + i * width_;
+    }
+
+    [[nodiscard]] const word* cube(std::size_t i) const noexcept
+    {
+        return words_.data() + i * width_;
+    }
+
+    /**
+     * Appends the cube without literals and returns it
+     */
+    word* add()
+    {
+        words_.resize(words_.size() + width_, ALL_BITS);
+        return cube(size() - 1);
+    }
+
+    /**
+     * Appends a copy of `c', which must not be a cube of this cover
+     */
+    void add(const word* c)
+    {
+        words_.insert(words_.end(), c, c + width_);
+    }
+
+    /**
+     * Removes the cubes flagged in `removed', keeping the others in order
+     */
+    void remove(const std::vector<bool>& removed)
+    {
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < size(); i++)
+        {
+            if (removed[i])
+                continue;
+            if (kept != i)
+                std::copy(cube(i), cube(i) + width_, cube(kept));
+            kept++;
+        }
+        words_.resize(kept * width_);
+    }
+
+private:
+    std::size_t width_;
+    std::vector<word> words_;
+};
+
+bool is_universal(const word* c, std::size_t width) noexcept
+{
+    for (std::size_t w = 0; w < width; w++)
+        if (c[w] != ALL_BITS)
+            return false;
+    return true;
+}
+
+bool is_empty(const word* c, std::size_t width) noexcept
+{
+    for (std::size_t w = 0; w < width; w++)
+        if (((c[w] | (c[w] >> 1)) & LOW_BITS) != LOW_BITS)
+            return true;
+    return false;
+}
+
+bool intersects(const word* a, const word* b, std::size_t width) noexcept
+{
+    for (std::size_t w = 0; w < width; w++)
+    {
+        const auto x = a[w] & b[w];
+        if (((x | (x >> 1)) & LOW_BITS) != LOW_BITS)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Returns whether every point of `inner' is a point of `outer'
+ */
+bool contains(const word* outer, const word* inner, std::size_t width) noexcept
+{
+    for (std::size_t w = 0; w < width; w++)
+        if ((inner[w] & ~outer[w]) != 0)
+            return false;
+    return true;
+}
+
+std::size_t literal_count(const word* c, std::size_t width) noexcept
+{
+    std::size_t count = 0;
+    for (std::size_t w = 0; w < width; w++)
+        count += static_cast<std::size_t>(__builtin_popcountll(literals(c[w])));
+    return count;
+}
+
+/**
+ * Returns the number of cubes and of literals of a cover, which is the
+ * cost the minimization lowers, cubes first
+ */
+std::pair<std::size_t, std::size_t> cost(const cover& f) noexcept
+{
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < f.size(); i++)
+        count += literal_count(f.cube(i), f.width());
+    return {f.size(), count};
+}
+
+/**
+ * Returns the indices of the cubes of `f' by increasing number of
+ * literals, or decreasing with `fewest_first' false
+ */
+std::vector<std::size_t> by_literals(const cover& f, bool fewest_first)
+{
+    std::vector<std::size_t> counts(f.size());
+    for (std::size_t i = 0; i < f.size(); i++)
+        counts[i] = literal_count(f.cube(i), f.width());
+
+    std::vector<std::size_t> order(f.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) {
+        return fewest_first ? counts[l] < counts[r] : counts[l] > counts[r];
+    });
+    return order;
+}
+
+/**
+ * Returns the cofactor of the cubes of `f' not flagged in `removed' with
+ * respect to the cube `p', in which the variables of `p' are free
+ */
+cover cofactor(const cover& f, const word* p, const std::vector<bool>& removed)
+{
+    const auto width = f.width();
+    cover result(width);
+    for (std::size_t i = 0; i < f.size(); i++)
+    {
+        const auto* c = f.cube(i);
+        if (removed[i] || !intersects(c, p, width))
+            continue;
+
+        auto* out = result.add();
+        for (std::size_t w = 0; w < width; w++)
+            out[w] = c[w] | ~p[w];
+    }
+    return result;
+}
+
+/**
+ * Returns the cofactor of `f' with respect to variable `var' set to
+ * `value'
+ */
+cover cofactor(const cover& f, std::size_t var, bool value)
+{
+    const auto w = var / FIELDS_PER_WORD;
+    const auto field = field_mask(var);
+    const auto allowed = field & (value ? ~LOW_BITS : LOW_BITS);
+
+    cover result(f.width());
+    for (std::size_t i = 0; i < f.size(); i++)
+    {
+        const auto* c = f.cube(i);
+        if ((c[w] & allowed) == 0)
+            continue;
+
+        result.add(c);
+        result.cube(result.size() - 1)[w] |= field;
+    }
+    return result;
+}
+
+/**
+ * Returns the variable to split `f' on among the fields set in `among',
+ * which is the one the most cubes have a literal of
+ */
+std::size_t split_variable(const cover& f, const std::vector<word>& among)
+{
+    const auto width = f.width();
+    std::vector<std::size_t> counts(width * FIELDS_PER_WORD);
+    for (std::size_t i = 0; i < f.size(); i++)
+    {
+        const auto* c = f.cube(i);
+        for (std::size_t w = 0; w < width; w++)
+            for (auto bits = literals(c[w]) & among[w]; bits != 0; bits &= bits - 1)
+                counts[field_variable(w, bits)]++;
+    }
+    return static_cast<std::size_t>(
+        std::max_element(counts.begin(), counts.end()) - counts.begin());
+}
+
+/**
+ * Collects the variables that cubes of `f' have a positive literal of in
+ * `positive', and a negative literal of in `negative'
+ *
+ * @return Whether `f' holds a cube without literals, in which case the
+ * variables are not all collected
+ */
+bool collect_signs(const cover& f, std::vector<word>& positive, std::vector<word>& negative)
+{
+    const auto width = f.width();
+    std::fill(positive.begin(), positive.end(), 0);
+    std::fill(negative.begin(), negative.end(), 0);
+
+    for (std::size_t i = 0; i < f.size(); i++)
+    {
+        const auto* c = f.cube(i);
+        if (is_universal(c, width))
+            return true;
+
+        for (std::size_t w = 0; w < width; w++)
+        {
+            positive[w] |= positive_literals(c[w]);
+            negative[w] |= negative_literals(c[w]);
+        }
+    }
+    return false;
+}
+
+/**
+ * Computes the cube of the negations of the single literal cubes of `f',
+ * which is empty if two of them are complementary
+ *
+ * @return Whether `f' has a single literal cube
+ */
+bool negated_units(const cover& f, word* out)
+{
+    const auto width = f.width();
+    std::fill(out, out + width, ALL_BITS);
+
+    bool any = false;
+    for (std::size_t i = 0; i < f.size(); i++)
+    {
+        const auto* c = f.cube(i);
+        if (literal_count(c, width) != 1)
+            continue;
+
+        for (std::size_t w = 0; w < width; w++)
+            out[w] &= ~(c[w] & (literals(c[w]) * 3));
+        any = true;
+    }
+    return any;
+}
+
+/**
+ * Decides whether the union of the cubes of `f' is the whole space
+ *
+ * A single literal cube covers every point where its literal holds, so
+ * only the cofactor where none of them do is checked. A cube with a
+ * literal of a unate variable, one whose literals all have the same
+ * sign, is dropped: setting the variable against that sign falsifies the
+ * cube and leaves the others as they are. Once every variable left is
+ * binate, the cover is split on the most frequent one and both cofactors
+ * must be tautologies. The recursion is at most as deep as there are
+ * variables.
+ */
+bool is_tautology(cover f)
+{
+    const auto width = f.width();
+    std::vector<word> positive(width);
+    std::vector<word> negative(width);
+    std::vector<word> unate(width);
+    std::vector<word> units(width);
+
+    for (;;)
+    {
+        if (f.size() == 0)
+            return false;
+        if (collect_signs(f, positive, negative))
+            return true;
+
+        // A cube with k literals covers a 2^-k fraction of the space
+        double covered = 0;
+        for (std::size_t i = 0; i < f.size(); i++)
+            covered += std::ldexp(1.0, -static_cast<int>(literal_count(f.cube(i), width)));
+        if (covered < 1)
+            return false;
+
+        if (negated_units(f, units.data()))
+        {
+            if (is_empty(units.data(), width))
+                return true;
+            f = cofactor(f, units.data(), std::vector<bool>(f.size()));
+            continue;
+        }
+
+        bool any_unate = false;
+        for (std::size_t w = 0; w < width; w++)
+        {
+            unate[w] = positive[w] ^ negative[w];
+            any_unate |= unate[w] != 0;
+        }
+        if (!any_unate)
+            break;
+
+        cover reduced(width);
+        for (std::size_t i = 0; i < f.size(); i++)
+        {
+            const auto* c = f.cube(i);
+            bool keep = true;
+            for (std::size_t w = 0; w < width && keep; w++)
+                keep = (literals(c[w]) & unate[w]) == 0;
+            if (keep)
+                reduced.add(c);
+        }
+        f = std::move(reduced);
+    }
+
+    // The half with fewer cubes is the more likely to leave a point out
+    const auto var = split_variable(f, positive);
+    auto low = cofactor(f, var, false);
+    auto high = cofactor(f, var, true);
+    if (high.size() < low.size())
+        std::swap(low, high);
+    return is_tautology(std::move(low)) && is_tautology(std::move(high));
+}
+
+bool intersects_any(const cover& f, const word* c)
+{
+    for (std::size_t i = 0; i < f.size(); i++)
+        if (intersects(f.cube(i), c, f.width()))
+            return true;
+    return false;
+}
+
+/**
+ * Returns whether `c' lies within the cubes of `f' not flagged in
+ * `removed'
+ */
+bool is_covered(const cover& f, const word* c, const std::vector<bool>& removed)
+{
+    return is_tautology(cofactor(f, c, removed));
+}
+
+/**
+ * Computes the smallest cube containing the complement of `f'
+ *
+ * The complement lies within the negations of the single literal cubes
+ * of `f', so only the cofactor on those is looked at. Without single
+ * literal cubes, the complement of a unate cover holds the point that
+ * sets every variable against the sign of its literals, and each
+ * variable can be flipped from there, so the cube has no literals.
+ * Otherwise `f' is split on its most frequent binate variable and the
+ * cubes of the two halves are merged back.
+ *
+ * @param f The cover
+ * @param out Receives the cube, unless the complement is empty
+ * @return Whether the complement is non-empty
+ */
+bool complement_supercube(const cover& f, word* out)
+{
+    const auto width = f.width();
+    std::vector<word> positive(width);
+    std::vector<word> negative(width);
+    if (collect_signs(f, positive, negative))
+        return false;
+
+    std::vector<word> units(width);
+    if (negated_units(f, units.data()))
+    {
+        if (is_empty(units.data(), width)
+            || !complement_supercube(
+                cofactor(f, units.data(), std::vector<bool>(f.size())), out))
+        {
+            return false;
+        }
+
+        for (std::size_t w = 0; w < width; w++)
+            out[w] &= units[w];
+        return true;
+    }
+
+    bool any_binate = false;
+    for (std::size_t w = 0; w < width; w++)
+    {
+        positive[w] &= negative[w];
+        any_binate |= positive[w] != 0;
+    }
+
+    if (!any_binate)
+    {
+        std::fill(out, out + width, ALL_BITS);
+        return true;
+    }
+
+    const auto var = split_variable(f, positive);
+    const auto w = var / FIELDS_PER_WORD;
+    const auto field = field_mask(var);
+
+    // The half with fewer cubes has the larger complement. Once its cube
+    // spans every other variable, the other half only decides whether
+    // the variable is free.
+    auto first_half = cofactor(f, var, false);
+    auto second_half = cofactor(f, var, true);
+    auto first_sign = LOW_BITS;
+    if (second_half.size() < first_half.size())
+    {
+        std::swap(first_half, second_half);
+        first_sign = ~LOW_BITS;
+    }
+
+    std::vector<word> first(width);
+    const auto has_first = complement_supercube(first_half, first.data());
+    if (has_first && is_universal(first.data(), width))
+    {
+        std::copy(first.begin(), first.end(), out);
+        if (is_tautology(std::move(second_half)))
+            out[w] &= ~field | first_sign;
+        return true;
+    }
+
+    std::vector<word> second(width);
+    const auto has_second = complement_supercube(second_half, second.data());
+    if (!has_first && !has_second)
+        return false;
+
+    first[w] &= ~field | first_sign;
+    second[w] &= ~field | ~first_sign;
+    for (std::size_t i = 0; i < width; i++)
+        out[i] = (has_first ? first[i] : 0) | (has_second ? second[i] : 0);
+    return true;
+}
+
+/**
+ * Removes the cubes of `f' that another cube contains
+ */
+void drop_contained(cover& f)
+{
+    const auto width = f.width();
+    const auto order = by_literals(f, true);
+    std::vector<bool> removed(f.size());
+
+    std::vector<std::size_t> kept;
+    for (const auto i : order)
+    {
+        for (const auto k : kept)
+        {
+            if (contains(f.cube(k), f.cube(i), width))
+            {
+                removed[i] = true;
+                break;
+            }
+        }
+        if (!removed[i])
+            kept.push_back(i);
+    }
+    f.remove(removed);
+}
+
+/**
+ * Computes a cover of the complement of `f'
+ *
+ * The complement of a single cube is the union of its negated literals.
+ * Otherwise `f' is split on its most frequent variable, binate ones
+ * first, and the cubes the complements of both cofactors share are
+ * merged back with the variable free.
+ *
+ * @param f The cover
+ * @param budget Maximum number of cubes of any complement computed
+ * @param out Receives the complement
+ * @return Whether every complement fit in `budget' cubes
+ */
+bool complement(const cover& f, std::size_t budget, cover& out)
+{
+    const auto width = f.width();
+    out = cover(width);
+
+    std::vector<word> positive(width);
+    std::vector<word> negative(width);
+    if (collect_signs(f, positive, negative))
+        return true;
+
+    if (f.size() <= 1)
+    {
+        if (f.size() == 0)
+            out.add();
+
+        for (std::size_t i = 0; i < f.size(); i++)
+        {
+            const auto* c = f.cube(i);
+            for (std::size_t w = 0; w < width; w++)
+                for (auto bits = literals(c[w]); bits != 0; bits &= bits - 1)
+                    out.add()[w] = ALL_BITS ^ (c[w] & ((bits & -bits) * 3));
+        }
+        return out.size() <= budget;
+    }
+
+    bool any_binate = false;
+    for (std::size_t w = 0; w < width; w++)
+        any_binate |= (positive[w] & negative[w]) != 0;
+    for (std::size_t w = 0; w < width; w++)
+    {
+        if (any_binate)
+            positive[w] &= negative[w];
+        else
+            positive[w] |= negative[w];
+    }
+    const auto var = split_variable(f, positive);
+    const auto w = var / FIELDS_PER_WORD;
+    const auto field = field_mask(var);
+
+    cover low(width);
+    cover high(width);
+    if (!complement(cofactor(f, var, false), budget, low)
+        || !complement(cofactor(f, var, true), budget, high))
+    {
+        return false;
+    }
+
+    const auto compare = [width](const word* a, const word* b) {
+        for (std::size_t i = 0; i < width; i++)
+            if (a[i] != b[i])
+                return a[i] < b[i] ? -1 : 1;
+        return 0;
+    };
+    const auto sorted = [&](const cover& half) {
+        std::vector<std::size_t> order(half.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+            return compare(half.cube(a), half.cube(b)) < 0;
+        });
+        return order;
+    };
+    const auto low_order = sorted(low);
+    const auto high_order = sorted(high);
+
+    // Walk both halves in order, so that equal cubes meet
+    auto l = low_order.begin();
+    auto h = high_order.begin();
+    while (l != low_order.end() || h != high_order.end())
+    {
+        const auto* lc = l != low_order.end() ? low.cube(*l) : nullptr;
+        const auto* hc = h != high_order.end() ? high.cube(*h) : nullptr;
+        const auto order = lc == nullptr ? 1 : hc == nullptr ? -1 : compare(lc, hc);
+
+        if (order == 0)
+        {
+            out.add(lc);
+            ++l;
+            ++h;
+        }
+        else if (order < 0)
+        {
+            out.add(lc);
+            out.cube(out.size() - 1)[w] &= ~field | LOW_BITS;
+            ++l;
+        }
+        else
+        {
+            out.add(hc);
+            out.cube(out.size() - 1)[w] &= ~field | ~LOW_BITS;
+            ++h;
+        }
+    }
+
+    drop_contained(out);
+    return out.size() <= budget;
+}
+
+/**
+ * Expands every cube of `f' into a prime implicant and drops the cubes
+ * the expanded ones contain
+ *
+ * Cubes are expanded largest first, since they are the most likely to
+ * absorb others. A literal is raised if the raised cube still misses
+ * every cube of the complement `offset', or without one, if it still
+ * lies within `f'. The literals that the most other cubes disagree with
+ * are tried first, as raising them moves the cube toward those cubes.
+ */
+void expand(cover& f, const cover* offset)
+{
+    const auto width = f.width();
+    const auto order = by_literals(f, true);
+    std::vector<bool> removed(f.size());
+
+    std::vector<std::size_t> scores(width * FIELDS_PER_WORD);
+    std::vector<std::size_t> candidates;
+    std::vector<word> raised(width);
+
+    for (const auto i : order)
+    {
+        if (removed[i])
+            continue;
+
+        auto* c = f.cube(i);
+        for (std::size_t j = 0; j < f.size(); j++)
+        {
+            if (j == i || removed[j])
+                continue;
+
+            const auto* d = f.cube(j);
+            for (std::size_t w = 0; w < width; w++)
+            {
+                const auto x = c[w] & d[w];
+                for (auto bits = ~(x | (x >> 1)) & LOW_BITS; bits != 0; bits &= bits - 1)
+                    scores[field_variable(w, bits)]++;
+            }
+        }
+
+        candidates.clear();
+        for (std::size_t w = 0; w < width; w++)
+            for (auto bits = literals(c[w]); bits != 0; bits &= bits - 1)
+                candidates.push_back(field_variable(w, bits));
+        std::stable_sort(candidates.begin(), candidates.end(), [&](std::size_t l, std::size_t r) {
+            return scores[l] > scores[r];
+        });
+
+        for (const auto var : candidates)
+        {
+            scores[var] = 0;
+
+            std::copy(c, c + width, raised.begin());
+            raised[var / FIELDS_PER_WORD] |= field_mask(var);
+            if (offset != nullptr ? !intersects_any(*offset, raised.data())
+                                  : is_covered(f, raised.data(), removed))
+            {
+                std::copy(raised.begin(), raised.end(), c);
+            }
+        }
+
+        for (std::size_t j = 0; j < f.size(); j++)
+            if (j != i && !removed[j] && contains(c, f.cube(j), width))
+                removed[j] = true;
+    }
+
+    f.remove(removed);
+}
+
+/**
+ * Removes cubes of `f' that the others cover, trying the smallest first
+ */
+void irredundant(cover& f)
+{
+    const auto order = by_literals(f, false);
+    std::vector<bool> removed(f.size());
+
+    for (const auto i : order)
+    {
+        removed[i] = true;
+        if (!is_covered(f, f.cube(i), removed))
+            removed[i] = false;
+    }
+
+    f.remove(removed);
+}
+
+/**
+ * Shrinks every cube of `f' to the smallest cube holding the points no
+ * other cube covers, largest first, and drops the cubes left with none
+ *
+ * The cover computes the same function, but its cubes are no longer
+ * prime, so that the next `expand' can grow them in other directions.
+ */
+void reduce(cover& f)
+{
+    const auto width = f.width();
+    const auto order = by_literals(f, true);
+    std::vector<bool> removed(f.size());
+    std::vector<word> supercube(width);
+
+    for (const auto i : order)
+    {
+        auto* c = f.cube(i);
+        removed[i] = true;
+        if (!complement_supercube(cofactor(f, c, removed), supercube.data()))
+            continue;
+
+        for (std::size_t w = 0; w < width; w++)
+            c[w] &= supercube[w];
+        removed[i] = false;
+    }
+
+    f.remove(removed);
+}
+
+/**
+ * Returns the identifiers of an expression, in order of first appearance
+ */
+std::vector<symbol_table::symbol> collect_variables(const expression& expr)
+{
+    std::vector<symbol_table::symbol> variables;
+    std::unordered_map<symbol_table::symbol, std::size_t> seen;
+
+    std::vector<const expression*> work = {&expr};
+    while (!work.empty())
+    {
+        const auto* e = work.back();
+        work.pop_back();
+
+        visit(
+            *e,
+            overloaded{
+                [&](const expression_identifier& ident) {
+                    if (seen.emplace(ident.symbol(), variables.size()).second)
+                        variables.push_back(ident.symbol());
+                },
+                [&](const expression_unary& unary) { work.push_back(&unary.inner()); },
+                [&](const expression_binary& binary) {
+                    const auto& operands = binary.operands();
+                    for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                        work.push_back(it->get());
+                },
+            });
+    }
+
+    return variables;
+}
+
+/**
+ * Builds the cover of an expression in negation normal form by
+ * distributing AND over OR
+ *
+ * The expression is walked in post-order with an explicit stack of
+ * covers. Empty products are dropped and contained cubes removed as the
+ * covers are built.
+ *
+ * @param expr The expression, in negation normal form
+ * @param variables The identifiers of `expr', whose positions number the
+ * variables of the cubes
+ * @param budget Maximum number of cubes of any cover built
+ * @param out Receives the cover
+ * @return Whether every cover fit in `budget' cubes
+ */
+bool build_cover(
+    const expression& expr,
+    const std::vector<symbol_table::symbol>& variables,
+    std::size_t budget,
+    cover& out)
+{
+    struct frame
+    {
+        const expression* expr;
+        bool expanded;
+    };
+
+    const auto width = out.width();
+
+    std::unordered_map<symbol_table::symbol, std::size_t> index;
+    for (std::size_t v = 0; v < variables.size(); v++)
+        index.emplace(variables[v], v);
+
+    std::vector<frame> work = {{&expr, false}};
+    std::vector<cover> done;
+
+    while (!work.empty())
+    {
+        const auto f = work.back();
+        work.pop_back();
+
+        if (f.expr->type() != expression::type::BINARY)
+        {
+            const auto negated = f.expr->type() == expression::type::UNARY;
+            const auto& ident = static_cast<const expression_identifier&>(
+                negated ? static_cast<const expression_unary&>(*f.expr).inner() : *f.expr);
+            const auto var = index.at(ident.symbol());
+
+            // A literal clears the bit of the value it rules out
+            const auto cleared = field_mask(var) & (negated ? ~LOW_BITS : LOW_BITS);
+            cover leaf(width);
+            leaf.add()[var / FIELDS_PER_WORD] &= ~cleared;
+            done.push_back(std::move(leaf));
+            continue;
+        }
+
+        const auto& binary = static_cast<const expression_binary&>(*f.expr);
+        const auto& operands = binary.operands();
+        if (!f.expanded)
+        {
+            work.push_back({f.expr, true});
+            for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                work.push_back({it->get(), false});
+            continue;
+        }
+
+        const auto first = done.end() - static_cast<std::ptrdiff_t>(operands.size());
+        cover result = std::move(*first);
+
+        for (auto it = first + 1; it != done.end(); ++it)
+        {
+            if (binary.op() == expression_binary::kind::OR)
+            {
+                for (std::size_t i = 0; i < it->size(); i++)
+                    result.add(it->cube(i));
+                continue;
+            }
+
+            cover product(width);
+            for (std::size_t l = 0; l < result.size(); l++)
+            {
+                for (std::size_t r = 0; r < it->size(); r++)
+                {
+                    if (!intersects(result.cube(l), it->cube(r), width))
+                        continue;
+
+                    auto* c = product.add();
+                    for (std::size_t w = 0; w < width; w++)
+                        c[w] = result.cube(l)[w] & it->cube(r)[w];
+                }
+            }
+            drop_contained(product);
+            if (product.size() > budget)
+                return false;
+            result = std::move(product);
+        }
+
+        if (binary.op() == expression_binary::kind::OR)
+        {
+            drop_contained(result);
+            if (result.size() > budget)
+                return false;
+        }
+
+        done.erase(first, done.end());
+        done.push_back(std::move(result));
+    }
+
+    assert(done.size() == 1);
+    out = std::move(done.back());
+    return true;
+}
+
+std::unique_ptr<expression> literal_expression(symbol_table::symbol sym, bool negated)
+{
+    std::unique_ptr<expression> ident = make_identifier(sym);
+    if (negated)
+        ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+    return ident;
+}
+
+/**
+ * Builds the OR of the ANDs of the literals of the cubes of `f'
+ *
+ * The empty cover, which is FALSE, is spelled out as <ID> AND NOT(<ID>)
+ * and a cube without literals, which is TRUE, as <ID> OR NOT(<ID>).
+ */
+std::unique_ptr<expression>
+build_expression(const cover& f, const std::vector<symbol_table::symbol>& variables)
+{
+    const auto width = f.width();
+    const auto any = variables.front();
+
+    if (f.size() == 0)
+    {
+        return make_binary(
+            expression_binary::kind::AND,
+            literal_expression(any, false),
+            literal_expression(any, true));
+    }
+
+    expression_binary::operand_list terms;
+    for (std::size_t i = 0; i < f.size(); i++)
+    {
+        const auto* c = f.cube(i);
+
+        expression_binary::operand_list factors;
+        for (std::size_t w = 0; w < width; w++)
+        {
+            for (auto bits = literals(c[w]); bits != 0; bits &= bits - 1)
+            {
+                const auto bit = bits & -bits;
+                factors.push_back(literal_expression(
+                    variables[field_variable(w, bit)], (negative_literals(c[w]) & bit) != 0));
+            }
+        }
+
+        if (factors.empty())
+        {
+            return make_binary(
+                expression_binary::kind::OR,
+                literal_expression(any, false),
+                literal_expression(any, true));
+        }
+
+        if (factors.size() == 1)
+            terms.push_back(std::move(factors.front()));
+        else
+            terms.push_back(make_binary(expression_binary::kind::AND, std::move(factors)));
+    }
+
+    if (terms.size() == 1)
+        return std::move(terms.front());
+    return make_binary(expression_binary::kind::OR, std::move(terms));
+}
+} // namespace
+
+/**
+ * Minimizes the given expression as a two-level sum of products
+ *
+ * The expression is converted to a cover of cubes, each packed into
+ * words of 32 two-bit fields, one per variable. The cover is then
+ * minimized with the heuristic loop of Espresso: `expand' makes every
+ * cube prime and drops those it absorbs, `irredundant' drops cubes the
+ * others cover, and `reduce' shrinks the cubes again so that the next
+ * expansion can find a better cover. The loop stops once an iteration
+ * no longer lowers the number of cubes, then of literals. Containment is
+ * decided with tautology checks on cofactors, so no complement of the
+ * cover is ever built.
+ *
+ * The result is an OR of ANDs of literals, which is not guaranteed to be
+ * smaller than `expr' when `expr' is not itself in that form. FALSE is
+ * spelled out as <ID> AND NOT(<ID>) and TRUE as <ID> OR NOT(<ID>).
+ *
+ * @param expr The expression to minimize
+ * @param budget Maximum number of cubes held during the conversion
+ * @return Owning reference to the minimized expression, or `nullptr' if
+ * its cover needs more than `budget' cubes
+ */
+std::unique_ptr<expression> minimize(const expression& expr, std::size_t budget)
+{
+    const auto nnf = to_nnf(expr);
+    const auto variables = collect_variables(*nnf);
+    const auto width = (variables.size() + FIELDS_PER_WORD - 1) / FIELDS_PER_WORD;
+
+    cover f(width);
+    if (!build_cover(*nnf, variables, budget, f))
+        return nullptr;
+
+    // Expanding against the complement is much cheaper than checking
+    // containment in `f', when the complement is small enough to build
+    cover offset(width);
+    const auto* blocking = complement(f, budget, offset) ? &offset : nullptr;
+
+    expand(f, blocking);
+    irredundant(f);
+
+    auto best = cost(f);
+    for (;;)
+    {
+        auto next = f;
+        reduce(next);
+        expand(next, blocking);
+        irredundant(next);
+
+        const auto next_cost = cost(next);
+        if (!(next_cost < best))
+            break;
+
+        f = std::move(next);
+        best = next_cost;
+    }
+
+    return build_expression(f, variables);
+}
@@ -0,0 +1,372 @@
+#include "normal_form.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include "simplifier.hpp"
+#include "symbol_table.hpp"
+
+namespace
+{
+// A literal is a symbol shifted left by one, with the low bit set if it
+// is negated, so that sorting a clause puts a literal next to its negation
+using literal = std::uint32_t;
+using clause = std::vector<literal>;
+using clause_set = std::vector<clause>;
+
+// Number of the next variable of `tseitin', shared by all calls, so that
+// the results of two calls never share a fresh variable
+std::atomic<std::uint64_t> next_gate(1);
+
+literal make_literal(symbol_table::symbol sym, bool negated) noexcept
+{
+    return sym << 1 | static_cast<literal>(negated);
+}
+
+/**
+ * Returns the literal of a leaf of an expression in negation normal form
+ */
+literal leaf_literal(const expression& expr)
+{
+    if (expr.type() == expression::type::IDENTIFIER)
+        return make_literal(static_cast<const expression_identifier&>(expr).symbol(), false);
+
+    const auto& inner = static_cast<const expression_unary&>(expr).inner();
+    return make_literal(static_cast<const expression_identifier&>(inner).symbol(), true);
+}
+
+std::unique_ptr<expression> literal_expression(literal lit)
+{
+    std::unique_ptr<expression> ident = make_identifier(lit >> 1);
+    if ((lit & 1) != 0)
+        ident = make_unary(expression_unary::kind::NOT, std::move(ident));
+    return ident;
+}
+
+/**
+ * Sorts and deduplicates the literals of a clause
+ *
+ * @return Whether the clause holds a literal together with its negation
+ */
+bool normalize(clause& c)
+{
+    std::sort(c.begin(), c.end());
+    c.erase(std::unique(c.begin(), c.end()), c.end());
+
+    for (std::size_t i = 1; i < c.size(); i++)
+        if (c[i] >> 1 == c[i - 1] >> 1)
+            return true;
+    return false;
+}
+
+std::size_t literal_count(const clause_set& set) noexcept
+{
+    std::size_t count = 0;
+    for (const auto& c : set)
+        count += c.size();
+    return count;
+}
+
+/**
+ * Builds the expression <OUTER> over the clauses of `set', each of which
+ * is <INNER> over its literals
+ *
+ * An empty set is the neutral element of <OUTER>, which is spelled out
+ * as `sym' combined with its negation by <INNER>.
+ */
+std::unique_ptr<expression> build(
+    const clause_set& set,
+    expression_binary::kind outer,
+    expression_binary::kind inner,
+    symbol_table::symbol sym)
+{
+    if (set.empty())
+    {
+        return make_binary(
+            inner, literal_expression(make_literal(sym, false)),
+            literal_expression(make_literal(sym, true)));
+    }
+
+    expression_binary::operand_list clauses;
+    for (const auto& c : set)
+    {
+        expression_binary::operand_list literals;
+        for (const auto lit : c)
+            literals.push_back(literal_expression(lit));
+
+        if (literals.size() == 1)
+            clauses.push_back(std::move(literals.front()));
+        else
+            clauses.push_back(make_binary(inner, std::move(literals)));
+    }
+
+    if (clauses.size() == 1)
+        return std::move(clauses.front());
+    return make_binary(outer, std::move(clauses));
+}
+
+/**
+ * Converts an expression in negation normal form to <OUTER> over
+ * <INNER> over literals by distributing <INNER> over <OUTER>
+ *
+ * The expression is walked in post-order with an explicit stack of
+ * clause sets. Clauses holding a literal and its negation are neutral
+ * for <OUTER> and dropped, and duplicate literals and clauses are
+ * removed as the sets are built.
+ *
+ * @param expr The expression, in negation normal form
+ * @param outer AND for CNF, OR for DNF
+ * @param budget Maximum number of literals held at any time
+ * @return The normal form, or `nullptr' if it needs more than `budget'
+ * literals
+ */
+std::unique_ptr<expression>
+distribute(const expression& expr, expression_binary::kind outer, std::size_t budget)
+{
+    const auto inner = outer == expression_binary::kind::AND ? expression_binary::kind::OR
+                                                             : expression_binary::kind::AND;
+
+    struct frame
+    {
+        const expression* expr;
+        bool expanded;
+    };
+
+    std::vector<frame> work = {{&expr, false}};
+    std::vector<clause_set> done;
+    std::size_t live = 0;
+    symbol_table::symbol any_symbol = 0;
+
+    while (!work.empty())
+    {
+        const auto f = work.back();
+        work.pop_back();
+
+        if (f.expr->type() != expression::type::BINARY)
+        {
+            const auto lit = leaf_literal(*f.expr);
+            any_symbol = lit >> 1;
+            done.push_back({{lit}});
+            live++;
+            continue;
+        }
+
+        const auto& binary = static_cast<const expression_binary&>(*f.expr);
+        const auto& operands = binary.operands();
+        if (!f.expanded)
+        {
+            work.push_back({f.expr, true});
+            for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                work.push_back({it->get(), false});
+            continue;
+        }
+
+        const auto first = done.end() - static_cast<std::ptrdiff_t>(operands.size());
+        clause_set result = std::move(*first);
+
+        for (auto it = first + 1; it != done.end(); ++it)
+        {
+            if (binary.op() == outer)
+            {
+                result.insert(
+                    result.end(),
+                    std::make_move_iterator(it->begin()),
+                    std::make_move_iterator(it->end()));
+                continue;
+            }
+
+            const auto before = literal_count(result) + literal_count(*it);
+
+            clause_set product;
+            std::size_t added = 0;
+            for (const auto& l : result)
+            {
+                for (const auto& r : *it)
+                {
+                    clause c;
+                    c.reserve(l.size() + r.size());
+                    c.insert(c.end(), l.begin(), l.end());
+                    c.insert(c.end(), r.begin(), r.end());
+                    if (normalize(c))
+                        continue;
+
+                    added += c.size();
+                    if (live + added > budget)
+                        return nullptr;
+                    product.push_back(std::move(c));
+                }
+            }
+
+            live = live + added - before;
+            result = std::move(product);
+        }
+
+        const auto before = literal_count(result);
+        std::sort(result.begin(), result.end());
+        result.erase(std::unique(result.begin(), result.end()), result.end());
+        live -= before - literal_count(result);
+
+        done.erase(first, done.end());
+        done.push_back(std::move(result));
+    }
+
+    assert(done.size() == 1);
+    return build(done.back(), outer, inner, any_symbol);
+}
+
+/**
+ * Converts an expression in negation normal form to an equisatisfiable
+ * CNF
+ *
+ * Every AND/OR node gets a fresh variable `$<N>', which cannot clash
+ * with an identifier of the input, and structurally equal nodes share
+ * theirs. N keeps counting across calls, so results can be conjoined and
+ * stay equisatisfiable with the conjunction of their inputs. Since
+ * negations only sit on identifiers, each node only needs the clauses
+ * for <VAR> -> <NODE> (the Plaisted-Greenbaum variant of the Tseitin
+ * encoding), so the result is linear in the size of `expr'.
+ *
+ * @param expr The expression, in negation normal form
+ * @return The CNF
+ */
+std::unique_ptr<expression> tseitin(const expression& expr)
+{
+    struct frame
+    {
+        const expression* expr;
+        bool expanded;
+    };
+
+    auto& symbols = symbol_table::instance();
+
+    clause_set clauses;
+    std::unordered_map<std::uint32_t, literal> gates;
+    std::vector<frame> work = {{&expr, false}};
+    std::vector<literal> done;
+
+    while (!work.empty())
+    {
+        const auto f = work.back();
+        work.pop_back();
+
+        if (f.expr->type() != expression::type::BINARY)
+        {
+            done.push_back(leaf_literal(*f.expr));
+            continue;
+        }
+
+        const auto& binary = static_cast<const expression_binary&>(*f.expr);
+        const auto& operands = binary.operands();
+        if (!f.expanded)
+        {
+            if (const auto it = gates.find(binary.id()); it != gates.end())
+            {
+                done.push_back(it->second);
+                continue;
+            }
+
+            work.push_back({f.expr, true});
+            for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                work.push_back({it->get(), false});
+            continue;
+        }
+
+        const auto gate = make_literal(symbols.intern(fmt::format("${}", next_gate++)), false);
+        const auto not_gate = gate | 1;
+        gates.emplace(f.expr->id(), gate);
+
+        const auto first = done.end() - static_cast<std::ptrdiff_t>(operands.size());
+        switch (binary.op())
+        {
+        case expression_binary::kind::AND:
+            for (auto it = first; it != done.end(); ++it)
+            {
+                clause c = {not_gate, *it};
+                if (!normalize(c))
+                    clauses.push_back(std::move(c));
+            }
+            break;
+
+        case expression_binary::kind::OR:
+        {
+            clause c = {not_gate};
+            c.insert(c.end(), first, done.end());
+            if (!normalize(c))
+                clauses.push_back(std::move(c));
+            break;
+        }
+        }
+
+        done.erase(first, done.end());
+        done.push_back(gate);
+    }
+
+    assert(done.size() == 1);
+    clauses.push_back({done.back()});
+
+    return build(
+        clauses, expression_binary::kind::AND, expression_binary::kind::OR, done.back() >> 1);
+}
+} // namespace
+
+/**
+ * Converts the given expression to conjunctive normal form
+ *
+ * In `cnf_mode::DISTRIBUTE' the result is equivalent to `expr', but may
+ * be exponentially larger, so the conversion gives up once it holds more
+ * than `budget' literals. In `cnf_mode::TSEITIN' the result is only
+ * equisatisfiable with `expr', through fresh variables, but it is linear
+ * in the size of `expr' and `budget' is not used.
+ *
+ * A CNF without clauses, which is TRUE, is spelled out as <ID> OR
+ * NOT(<ID>).
+ *
+ * @param expr The expression to convert
+ * @param mode The conversion to use
+ * @param budget Maximum number of literals held during the conversion
+ * @return Owning reference to the CNF, or `nullptr' if the budget was
+ * exceeded
+ */
+std::unique_ptr<expression> to_cnf(const expression& expr, cnf_mode mode, std::size_t budget)
+{
+    const auto nnf = to_nnf(expr);
+
+    switch (mode)
+    {
+    case cnf_mode::DISTRIBUTE:
+        return distribute(*nnf, expression_binary::kind::AND, budget);
+
+    case cnf_mode::TSEITIN:
+        return tseitin(*nnf);
+    }
+
+    assert(!"Invalid CNF mode");
+    return nullptr;
+}
+
+/**
+ * Converts the given expression to disjunctive normal form
+ *
+ * The result is equivalent to `expr', but may be exponentially larger, so
+ * the conversion gives up once it holds more than `budget' literals. A
+ * DNF without terms, which is FALSE, is spelled out as <ID> AND NOT(<ID>).
+ *
+ * @param expr The expression to convert
+ * @param budget Maximum number of literals held during the conversion
+ * @return Owning reference to the DNF, or `nullptr' if the budget was
+ * exceeded
+ */
+std::unique_ptr<expression> to_dnf(const expression& expr, std::size_t budget)
+{
+    const auto nnf = to_nnf(expr);
+    return distribute(*nnf, expression_binary::kind::OR, budget);
+}
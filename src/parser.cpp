@@ -1,122 +1,224 @@
 #include "parser.hpp"
 
+#include <iterator>
+
 parser::parser(lexer& lex)
     : lex_(lex)
-    , current_token(nullptr)
+    , arena_(nullptr)
+    , current_token(lex_.next_token())
+    , operators_()
+    , operands_()
 {
-    next();
 }
 
-std::unique_ptr<expression> parser::parse_expression()
+parser::parser(lexer& lex, expression_arena& arena)
+    : lex_(lex)
+    , arena_(&arena)
+    , current_token(lex_.next_token())
+    , operators_()
+    , operands_()
 {
-    return parse_add_expression();
 }
 
-std::unique_ptr<expression> parser::parse_add_expression()
+/**
+ * Parses the next expression of the input
+ *
+ * The grammar is
+ * * <EXPR> := <AND> [|| <EXPR>]
+ * * <AND> := <UNARY> [&& <AND>]
+ * * <UNARY> := !<UNARY> | (<EXPR>) | <IDENTIFIER>
+ *
+ * so both binary operators are right associative and `&&' binds tighter
+ * than `||'. It is parsed with operator precedence on explicit operator
+ * and operand stacks, so neither long chains of operators nor deep
+ * nesting use any call stack. Separators before the expression are
+ * skipped, and the token after it is left for the next call.
+ *
+ * @return Owning reference to the expression, or `nullptr' if the input
+ * does not start with a valid expression
+ */
+std::unique_ptr<expression> parser::parse_expression()
 {
-    auto left = parse_mul_expression();
-    if (!left)
-        return nullptr;
-
-    if (!match_operator_kind(*current_token, token_operator::kind::PIPEPIPE))
-        return left;
-    next();
+    const arena_scope scope(arena_ != nullptr ? arena_ : expression_arena::current());
 
-    auto right = parse_add_expression();
-    if (!right)
-        return nullptr;
+    std::size_t depth = 0;
+    skip_separators();
 
-    return make_binary(expression_binary::kind::OR, std::move(left), std::move(right));
+    for (;;)
+    {
+        // Operand: prefix operators and opening parentheses, up to an identifier
+        for (;;)
+        {
+            if (current_token.type() == token::type::IDENTIFIER)
+            {
+                operands_.push_back(make_identifier(current_token.text()));
+                next();
+                break;
+            }
+            else if (match_operator_kind(current_token, token::kind::EXCLAM))
+            {
+                operators_.push_back(pending::NOT);
+                next();
+            }
+            else if (match_operator_kind(current_token, token::kind::LPAREN))
+            {
+                operators_.push_back(pending::LPAREN);
+                depth++;
+                next();
+            }
+            else
+            {
+                return fail();
+            }
+        }
+
+        // Closing parentheses, up to a binary operator or the end of the expression
+        while (depth > 0 && match_operator_kind(current_token, token::kind::RPAREN))
+        {
+            reduce_above(pending::LPAREN);
+            operators_.pop_back();
+            depth--;
+            next();
+        }
+
+        if (match_operator_kind(current_token, token::kind::AMPERAMPER))
+        {
+            reduce_above(pending::AND);
+            operators_.push_back(pending::AND);
+            next();
+        }
+        else if (match_operator_kind(current_token, token::kind::PIPEPIPE))
+        {
+            reduce_above(pending::OR);
+            operators_.push_back(pending::OR);
+            next();
+        }
+        else if (depth > 0)
+        {
+            return fail();
+        }
+        else
+        {
+            reduce_above(pending::LPAREN);
+
+            assert(operators_.empty() && operands_.size() == 1);
+            auto expr = std::move(operands_.back());
+            operands_.pop_back();
+            return expr;
+        }
+    }
 }
 
-std::unique_ptr<expression> parser::parse_mul_expression()
+/**
+ * Parses the next statement of the input: an expression ended by a
+ * separator or by the end of the input
+ *
+ * Empty statements are skipped. If the statement is not a valid
+ * expression, the rest of it is skipped, so that the next call resumes
+ * with the next statement.
+ *
+ * @return Owning reference to the expression, `nullptr' if the statement
+ * is not a valid expression, or nothing at the end of the input
+ */
+std::optional<std::unique_ptr<expression>> parser::parse_statement()
 {
-    auto left = parse_unary_expression();
-    if (!left)
-        return nullptr;
-
-    if (!match_operator_kind(*current_token, token_operator::kind::AMPERAMPER))
-        return left;
-    next();
+    skip_separators();
+    if (current_token.type() == token::type::END)
+        return std::nullopt;
 
-    auto right = parse_mul_expression();
-    if (!right)
-        return nullptr;
+    auto expr = parse_expression();
 
-    return make_binary(expression_binary::kind::AND, std::move(left), std::move(right));
-}
-
-std::unique_ptr<expression> parser::parse_unary_expression()
-{
-    switch (current_token->type())
-    {
-    case token::type::IDENTIFIER:
-        return parse_identifier_expression();
+    const auto type = current_token.type();
+    if (expr != nullptr && (type == token::type::SEPARATOR || type == token::type::END))
+        return expr;
 
-    case token::type::OPERATOR:
+    while (current_token.type() != token::type::SEPARATOR
+           && current_token.type() != token::type::END)
     {
-        if (!match_operator_kind(*current_token, token_operator::kind::EXCLAM))
-            break;
         next();
-
-        auto expr = parse_unary_expression();
-        if (!expr)
-            return nullptr;
-
-        return make_unary(expression_unary::kind::NOT, std::move(expr));
     }
-
-    default:
-        break;
-    }
-
-    return parse_primary_expression();
+    return nullptr;
 }
 
-std::unique_ptr<expression> parser::parse_primary_expression()
+void parser::next()
 {
-    switch (current_token->type())
-    {
-    case token::type::IDENTIFIER:
-        return parse_identifier_expression();
+    current_token = lex_.next_token();
+}
 
-    case token::type::OPERATOR:
-    {
-        if (!match_operator_kind(*current_token, token_operator::kind::LPAREN))
-            return nullptr;
+void parser::skip_separators()
+{
+    while (current_token.type() == token::type::SEPARATOR)
         next();
+}
 
-        auto expr = parse_expression();
+/**
+ * Applies the operator on top of the operator stack to the operands on
+ * top of the operand stack
+ *
+ * Binary operators are applied together with every operator of the same
+ * kind directly below them.
+ */
+void parser::reduce()
+{
+    const auto op = operators_.back();
+    operators_.pop_back();
 
-        if (!match_operator_kind(*current_token, token_operator::kind::RPAREN))
-            return nullptr;
-        next();
+    switch (op)
+    {
+    case pending::NOT:
+    {
+        auto inner = std::move(operands_.back());
+        operands_.back() = make_unary(expression_unary::kind::NOT, std::move(inner));
+        break;
+    }
 
-        return expr;
+    case pending::AND:
+    case pending::OR:
+    {
+        // A run of the same operator is a right-nested chain, which is
+        // reduced into a single node at once
+        std::size_t count = 2;
+        while (!operators_.empty() && operators_.back() == op)
+        {
+            operators_.pop_back();
+            count++;
+        }
+
+        const auto first = operands_.end() - static_cast<std::ptrdiff_t>(count);
+        expression_binary::operand_list chain(
+            std::make_move_iterator(first), std::make_move_iterator(operands_.end()));
+        operands_.erase(first + 1, operands_.end());
+
+        const auto kind
+            = op == pending::AND ? expression_binary::kind::AND : expression_binary::kind::OR;
+        operands_.back() = make_binary(kind, std::move(chain));
+        break;
     }
 
-    default:
-        return nullptr;
+    case pending::LPAREN:
+        assert(!"Cannot reduce a parenthesis");
+        break;
     }
 }
 
-std::unique_ptr<expression> parser::parse_identifier_expression()
+/**
+ * Applies every pending operator that binds tighter than `op'
+ *
+ * Operators of the same precedence as `op' are left on the stack, which
+ * makes the binary operators right associative. Reduction never goes
+ * past an open parenthesis.
+ *
+ * @param op The operator about to be pushed
+ */
+void parser::reduce_above(pending op)
 {
-    switch (current_token->type())
-    {
-    case token::type::IDENTIFIER:
-    {
-        const auto tok_ident = dynamic_cast<const token_identifier&>(*current_token);
-        next();
-        return make_identifier(tok_ident.name());
-    }
-
-    default:
-        return nullptr;
-    }
+    while (!operators_.empty() && operators_.back() > op)
+        reduce();
 }
 
-void parser::next()
+std::unique_ptr<expression> parser::fail()
 {
-    current_token = lex_.next_token();
+    operators_.clear();
+    operands_.clear();
+    return nullptr;
 }
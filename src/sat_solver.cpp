@@ -0,0 +1,482 @@
+#include "sat_solver.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+constexpr std::int8_t UNASSIGNED = -1;
+
+// Activities decay by this factor at every conflict, by growing the bump
+constexpr double ACTIVITY_DECAY = 0.95;
+constexpr double ACTIVITY_LIMIT = 1e100;
+
+// Conflicts before the first restart, and the growth of the interval
+constexpr double RESTART_FIRST = 100;
+constexpr double RESTART_GROWTH = 1.5;
+} // namespace
+
+sat_solver::sat_solver() noexcept
+    : clauses_()
+    , watches_()
+    , values_()
+    , phases_()
+    , levels_()
+    , reasons_()
+    , activity_()
+    , seen_()
+    , heap_()
+    , heap_positions_()
+    , trail_()
+    , trail_levels_()
+    , propagated_(0)
+    , bump_(1)
+    , conflicts_(0)
+    , inconsistent_(false)
+{
+}
+
+/**
+ * Adds a fresh variable
+ *
+ * @return The variable, numbered from zero in order of creation
+ */
+sat_solver::variable sat_solver::add_variable()
+{
+    const auto var = static_cast<variable>(values_.size());
+    values_.push_back(UNASSIGNED);
+    phases_.push_back(false);
+    levels_.push_back(0);
+    reasons_.push_back(NO_CLAUSE);
+    activity_.push_back(0);
+    seen_.push_back(false);
+    heap_positions_.push_back(NOT_IN_HEAP);
+    watches_.emplace_back();
+    watches_.emplace_back();
+    heap_insert(var);
+    return var;
+}
+
+/**
+ * Adds the disjunction of `clause' to the formula
+ *
+ * Duplicate literals and literals already false are dropped, and clauses
+ * that hold a literal together with its negation or one already true are
+ * not stored. An empty clause makes the formula unsatisfiable.
+ *
+ * @param clause Literals made with `make_literal'
+ */
+void sat_solver::add_clause(std::vector<literal> clause)
+{
+    if (inconsistent_)
+        return;
+    backtrack(0);
+
+    std::sort(clause.begin(), clause.end());
+    clause.erase(std::unique(clause.begin(), clause.end()), clause.end());
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < clause.size(); i++)
+    {
+        const auto value = literal_value(clause[i]);
+        if (value == 1 || (i > 0 && clause[i] == (clause[i - 1] ^ 1)))
+            return;
+        if (value == UNASSIGNED)
+            clause[kept++] = clause[i];
+    }
+    clause.resize(kept);
+
+    switch (clause.size())
+    {
+    case 0:
+        inconsistent_ = true;
+        break;
+
+    case 1:
+        assign(clause.front(), NO_CLAUSE);
+        if (propagate() != NO_CLAUSE)
+            inconsistent_ = true;
+        break;
+
+    default:
+        clauses_.push_back(std::move(clause));
+        attach(static_cast<std::uint32_t>(clauses_.size() - 1));
+        break;
+    }
+}
+
+/**
+ * Decides whether the formula is satisfiable
+ *
+ * This is conflict-driven clause learning with two watched literals,
+ * first-UIP learning, activity-based decisions with phase saving, and
+ * restarts at geometrically growing intervals. Learnt clauses are kept,
+ * so the search is meant to be bounded by `conflict_budget'.
+ *
+ * @param conflict_budget Conflicts after which the search gives up
+ * @return Whether the formula is satisfiable, or `UNKNOWN' if the budget
+ *         ran out; after `SATISFIABLE', `value' reads the model
+ */
+sat_solver::result sat_solver::solve(std::size_t conflict_budget)
+{
+    if (inconsistent_)
+        return result::UNSATISFIABLE;
+    backtrack(0);
+
+    const auto limit = conflicts_ + conflict_budget;
+    auto restart_limit = RESTART_FIRST;
+    std::size_t restart_conflicts = 0;
+    std::vector<literal> learnt;
+
+    for (;;)
+    {
+        const auto conflict = propagate();
+        if (conflict != NO_CLAUSE)
+        {
+            conflicts_++;
+            restart_conflicts++;
+            if (trail_levels_.empty())
+            {
+                inconsistent_ = true;
+                return result::UNSATISFIABLE;
+            }
+
+            backtrack(analyze(conflict, learnt));
+            if (learnt.size() == 1)
+                assign(learnt.front(), NO_CLAUSE);
+            else
+            {
+                clauses_.push_back(learnt);
+                const auto index = static_cast<std::uint32_t>(clauses_.size() - 1);
+                attach(index);
+                assign(learnt.front(), index);
+            }
+            bump_ /= ACTIVITY_DECAY;
+            continue;
+        }
+
+        if (conflicts_ >= limit)
+        {
+            backtrack(0);
+            return result::UNKNOWN;
+        }
+
+        if (static_cast<double>(restart_conflicts) >= restart_limit)
+        {
+            restart_conflicts = 0;
+            restart_limit *= RESTART_GROWTH;
+            backtrack(0);
+        }
+
+        if (!decide())
+            return result::SATISFIABLE;
+    }
+}
+
+/**
+ * Returns the value of `var' in the model found by the last `solve'
+ */
+bool sat_solver::value(variable var) const
+{
+    return values_[var] == 1;
+}
+
+std::size_t sat_solver::variables() const noexcept
+{
+    return values_.size();
+}
+
+const std::size_t& sat_solver::conflicts() const noexcept
+{
+    return conflicts_;
+}
+
+/**
+ * Returns the literal of `var', which is `var' shifted left by one with
+ * the low bit set if it is negated, so that lit ^ 1 is its negation
+ */
+sat_solver::literal sat_solver::make_literal(variable var, bool negated) noexcept
+{
+    return var << 1 | static_cast<literal>(negated);
+}
+
+/**
+ * Returns 1 if `lit' is true, 0 if it is false and -1 if it is unassigned
+ */
+std::int8_t sat_solver::literal_value(literal lit) const noexcept
+{
+    const auto value = values_[lit >> 1];
+    if (value == UNASSIGNED)
+        return UNASSIGNED;
+    return static_cast<std::int8_t>(value ^ static_cast<std::int8_t>(lit & 1));
+}
+
+void sat_solver::assign(literal lit, std::uint32_t reason)
+{
+    const auto var = lit >> 1;
+    values_[var] = static_cast<std::int8_t>((lit & 1) ^ 1);
+    levels_[var] = static_cast<std::uint32_t>(trail_levels_.size());
+    reasons_[var] = reason;
+    trail_.push_back(lit);
+}
+
+/**
+ * Watches the first two literals of a clause
+ */
+void sat_solver::attach(std::uint32_t clause)
+{
+    const auto& c = clauses_[clause];
+    watches_[c[0]].push_back(clause);
+    watches_[c[1]].push_back(clause);
+}
+
+/**
+ * Assigns the literals implied by the trail
+ *
+ * A clause watches two literals that are not false, and is only visited
+ * when one of them becomes false. The literal a clause implies is kept
+ * first, so that it can serve as the reason of the assignment.
+ *
+ * @return The clause that became false, or `NO_CLAUSE'
+ */
+std::uint32_t sat_solver::propagate()
+{
+    while (propagated_ < trail_.size())
+    {
+        const auto falsified = trail_[propagated_++] ^ 1;
+        auto& watching = watches_[falsified];
+
+        std::size_t kept = 0;
+        for (std::size_t i = 0; i < watching.size(); i++)
+        {
+            const auto index = watching[i];
+            auto& c = clauses_[index];
+            if (c[0] == falsified)
+                std::swap(c[0], c[1]);
+
+            if (literal_value(c[0]) == 1)
+            {
+                watching[kept++] = index;
+                continue;
+            }
+
+            const auto replacement = std::find_if(
+                c.begin() + 2,
+                c.end(),
+                [this](literal lit) { return literal_value(lit) != 0; });
+            if (replacement != c.end())
+            {
+                std::swap(c[1], *replacement);
+                watches_[c[1]].push_back(index);
+                continue;
+            }
+
+            watching[kept++] = index;
+            if (literal_value(c[0]) == 0)
+            {
+                for (i++; i < watching.size(); i++)
+                    watching[kept++] = watching[i];
+                watching.resize(kept);
+                return index;
+            }
+            assign(c[0], index);
+        }
+        watching.resize(kept);
+    }
+
+    return NO_CLAUSE;
+}
+
+/**
+ * Derives the first-UIP clause of a conflict
+ *
+ * The literals of the current decision level are resolved away along
+ * their reasons until one is left, which becomes the first literal of
+ * `learnt'; the literal of the highest remaining level comes second.
+ * Literals implied by the rest of the clause are then removed.
+ *
+ * @param conflict The clause that became false
+ * @param learnt Receives the learnt clause
+ * @return The level to backtrack to
+ */
+std::size_t sat_solver::analyze(std::uint32_t conflict, std::vector<literal>& learnt)
+{
+    const auto current = trail_levels_.size();
+    learnt.assign(1, 0);
+
+    std::size_t pending = 0;
+    auto index = trail_.size();
+    auto clause = conflict;
+    bool reason = false;
+    literal lit = 0;
+
+    do
+    {
+        const auto& c = clauses_[clause];
+        for (std::size_t i = reason ? 1 : 0; i < c.size(); i++)
+        {
+            const auto var = c[i] >> 1;
+            if (seen_[var] || levels_[var] == 0)
+                continue;
+
+            seen_[var] = true;
+            bump(var);
+            if (levels_[var] == current)
+                pending++;
+            else
+                learnt.push_back(c[i]);
+        }
+
+        do
+            lit = trail_[--index];
+        while (!seen_[lit >> 1]);
+
+        seen_[lit >> 1] = false;
+        clause = reasons_[lit >> 1];
+        reason = true;
+    } while (--pending > 0);
+
+    learnt.front() = lit ^ 1;
+
+    // A literal whose reason only holds other literals of the clause, or
+    // literals of level zero, is implied by them and can be dropped
+    std::size_t kept = 1;
+    for (std::size_t i = 1; i < learnt.size(); i++)
+    {
+        const auto reason_clause = reasons_[learnt[i] >> 1];
+        const auto implied = reason_clause != NO_CLAUSE
+            && std::all_of(
+                   clauses_[reason_clause].begin() + 1,
+                   clauses_[reason_clause].end(),
+                   [this](literal l) { return seen_[l >> 1] || levels_[l >> 1] == 0; });
+        if (!implied)
+            std::swap(learnt[kept++], learnt[i]);
+    }
+    for (std::size_t i = 1; i < learnt.size(); i++)
+        seen_[learnt[i] >> 1] = false;
+    learnt.resize(kept);
+
+    std::size_t level = 0;
+    for (std::size_t i = 1; i < learnt.size(); i++)
+    {
+        if (levels_[learnt[i] >> 1] > level)
+        {
+            level = levels_[learnt[i] >> 1];
+            std::swap(learnt[1], learnt[i]);
+        }
+    }
+    return level;
+}
+
+/**
+ * Undoes the assignments above decision level `level'
+ */
+void sat_solver::backtrack(std::size_t level)
+{
+    if (trail_levels_.size() <= level)
+        return;
+
+    for (auto i = trail_levels_[level]; i < trail_.size(); i++)
+    {
+        const auto var = trail_[i] >> 1;
+        phases_[var] = values_[var] == 1;
+        values_[var] = UNASSIGNED;
+        heap_insert(var);
+    }
+    trail_.resize(trail_levels_[level]);
+    trail_levels_.resize(level);
+    propagated_ = trail_.size();
+}
+
+void sat_solver::bump(variable var)
+{
+    activity_[var] += bump_;
+    if (activity_[var] > ACTIVITY_LIMIT)
+    {
+        for (auto& activity : activity_)
+            activity /= ACTIVITY_LIMIT;
+        bump_ /= ACTIVITY_LIMIT;
+    }
+
+    if (heap_positions_[var] != NOT_IN_HEAP)
+        heap_up(heap_positions_[var]);
+}
+
+/**
+ * Adds `var' to the heap of decision candidates, ordered by activity
+ */
+void sat_solver::heap_insert(variable var)
+{
+    if (heap_positions_[var] != NOT_IN_HEAP)
+        return;
+
+    heap_positions_[var] = static_cast<std::uint32_t>(heap_.size());
+    heap_.push_back(var);
+    heap_up(heap_.size() - 1);
+}
+
+void sat_solver::heap_up(std::size_t pos)
+{
+    const auto var = heap_[pos];
+    while (pos > 0)
+    {
+        const auto parent = (pos - 1) / 2;
+        if (activity_[heap_[parent]] >= activity_[var])
+            break;
+        heap_[pos] = heap_[parent];
+        heap_positions_[heap_[pos]] = static_cast<std::uint32_t>(pos);
+        pos = parent;
+    }
+    heap_[pos] = var;
+    heap_positions_[var] = static_cast<std::uint32_t>(pos);
+}
+
+void sat_solver::heap_down(std::size_t pos)
+{
+    const auto var = heap_[pos];
+    for (;;)
+    {
+        auto child = 2 * pos + 1;
+        if (child >= heap_.size())
+            break;
+        if (child + 1 < heap_.size() && activity_[heap_[child + 1]] > activity_[heap_[child]])
+            child++;
+        if (activity_[heap_[child]] <= activity_[var])
+            break;
+        heap_[pos] = heap_[child];
+        heap_positions_[heap_[pos]] = static_cast<std::uint32_t>(pos);
+        pos = child;
+    }
+    heap_[pos] = var;
+    heap_positions_[var] = static_cast<std::uint32_t>(pos);
+}
+
+/**
+ * Assigns the unassigned variable of highest activity its saved phase
+ *
+ * Assigned variables are only dropped from the heap when they reach its
+ * top, and are put back when they are unassigned.
+ *
+ * @return Whether there was an unassigned variable left
+ */
+bool sat_solver::decide()
+{
+    while (!heap_.empty())
+    {
+        const auto var = heap_.front();
+        heap_positions_[var] = NOT_IN_HEAP;
+        heap_.front() = heap_.back();
+        heap_.pop_back();
+        if (!heap_.empty())
+            heap_down(0);
+
+        if (values_[var] != UNASSIGNED)
+            continue;
+
+        trail_levels_.push_back(trail_.size());
+        assign(make_literal(var, !phases_[var]), NO_CLAUSE);
+        return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,181 @@
+#include "scanner.hpp"
+
+#include "lexer_table.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #define SCANNER_X86 1
+    #include <immintrin.h>
+#else
+    #define SCANNER_X86 0
+#endif
+
+namespace
+{
+using scan_fn = std::size_t (*)(const char*, const char*) noexcept;
+
+template<typename Pred>
+std::size_t scan_scalar(const char* begin, const char* end, Pred pred) noexcept
+{
+    const auto* it = begin;
+    while (it != end && pred(classify(*it)))
+        it++;
+    return static_cast<std::size_t>(it - begin);
+}
+
+bool is_identifier(char_class cls) noexcept
+{
+    return cls == char_class::LETTER || cls == char_class::DIGIT;
+}
+
+bool is_whitespace(char_class cls) noexcept
+{
+    return cls == char_class::WHITESPACE;
+}
+
+std::size_t identifier_scalar(const char* begin, const char* end) noexcept
+{
+    return scan_scalar(begin, end, is_identifier);
+}
+
+std::size_t whitespace_scalar(const char* begin, const char* end) noexcept
+{
+    return scan_scalar(begin, end, is_whitespace);
+}
+
+#if SCANNER_X86
+// Lanes of `x' within [lo, hi], with an unsigned comparison done as
+// min(x - lo, hi - lo) == x - lo
+__m128i in_range(__m128i x, char lo, char hi) noexcept
+{
+    const auto shifted = _mm_sub_epi8(x, _mm_set1_epi8(lo));
+    const auto width = _mm_set1_epi8(static_cast<char>(hi - lo));
+    return _mm_cmpeq_epi8(_mm_min_epu8(shifted, width), shifted);
+}
+
+__m128i identifier_mask(__m128i x) noexcept
+{
+    const auto lower = _mm_or_si128(x, _mm_set1_epi8(0x20));
+    const auto letters = in_range(lower, 'a', 'z');
+    const auto digits = in_range(x, '0', '9');
+    const auto underscore = _mm_cmpeq_epi8(x, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(letters, digits), underscore);
+}
+
+__m128i whitespace_mask(__m128i x) noexcept
+{
+    // `WHITESPACE' is \t \n \v, \r and the space, but not \f
+    const auto tab_to_vtab = in_range(x, '\t', '\v');
+    const auto cr = _mm_cmpeq_epi8(x, _mm_set1_epi8('\r'));
+    const auto space = _mm_cmpeq_epi8(x, _mm_set1_epi8(' '));
+    return _mm_or_si128(_mm_or_si128(tab_to_vtab, cr), space);
+}
+
+template<__m128i (*Mask)(__m128i), scan_fn Tail>
+std::size_t scan_sse2(const char* begin, const char* end) noexcept
+{
+    const auto* it = begin;
+    for (; end - it >= 16; it += 16)
+    {
+        const auto x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(it));
+        const auto miss = ~_mm_movemask_epi8(Mask(x)) & 0xFFFF;
+        if (miss != 0)
+            return static_cast<std::size_t>(it - begin) + __builtin_ctz(miss);
+    }
+    return static_cast<std::size_t>(it - begin) + Tail(it, end);
+}
+
+__attribute__((target("avx2"))) __m256i in_range(__m256i x, char lo, char hi) noexcept
+{
+    const auto shifted = _mm256_sub_epi8(x, _mm256_set1_epi8(lo));
+    const auto width = _mm256_set1_epi8(static_cast<char>(hi - lo));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, width), shifted);
+}
+
+__attribute__((target("avx2"))) __m256i identifier_mask(__m256i x) noexcept
+{
+    const auto lower = _mm256_or_si256(x, _mm256_set1_epi8(0x20));
+    const auto letters = in_range(lower, 'a', 'z');
+    const auto digits = in_range(x, '0', '9');
+    const auto underscore = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(letters, digits), underscore);
+}
+
+__attribute__((target("avx2"))) __m256i whitespace_mask(__m256i x) noexcept
+{
+    const auto tab_to_vtab = in_range(x, '\t', '\v');
+    const auto cr = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r'));
+    const auto space = _mm256_cmpeq_epi8(x, _mm256_set1_epi8(' '));
+    return _mm256_or_si256(_mm256_or_si256(tab_to_vtab, cr), space);
+}
+
+template<__m256i (*Mask)(__m256i), scan_fn Tail>
+__attribute__((target("avx2"))) std::size_t scan_avx2(const char* begin, const char* end) noexcept
+{
+    const auto* it = begin;
+    for (; end - it >= 32; it += 32)
+    {
+        const auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(it));
+        const auto miss = ~static_cast<std::uint32_t>(_mm256_movemask_epi8(Mask(x)));
+        if (miss != 0)
+            return static_cast<std::size_t>(it - begin) + __builtin_ctz(miss);
+    }
+    return static_cast<std::size_t>(it - begin) + Tail(it, end);
+}
+#endif
+
+struct scanners
+{
+    scan_fn identifier;
+    scan_fn whitespace;
+};
+
+scanners select_scanners() noexcept
+{
+#if SCANNER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return {
+            scan_avx2<identifier_mask, scan_sse2<identifier_mask, identifier_scalar>>,
+            scan_avx2<whitespace_mask, scan_sse2<whitespace_mask, whitespace_scalar>>};
+    }
+
+    if (__builtin_cpu_supports("sse2"))
+    {
+        return {
+            scan_sse2<identifier_mask, identifier_scalar>,
+            scan_sse2<whitespace_mask, whitespace_scalar>};
+    }
+#endif
+
+    return {identifier_scalar, whitespace_scalar};
+}
+
+const scanners SCANNERS = select_scanners();
+} // namespace
+
+/**
+ * Returns the length of the run of identifier characters `text' starts with
+ *
+ * The bytes are classified 32 (AVX2) or 16 (SSE2) at a time when the CPU
+ * supports it, with the same classes as the lexer automaton.
+ *
+ * @param text The text to scan
+ * @return Number of leading `LETTER' and `DIGIT' characters
+ */
+std::size_t scan_identifier(std::string_view text) noexcept
+{
+    return SCANNERS.identifier(text.data(), text.data() + text.size());
+}
+
+/**
+ * Returns the length of the run of whitespace `text' starts with
+ *
+ * @see scan_identifier
+ * @param text The text to scan
+ * @return Number of leading `WHITESPACE' characters
+ */
+std::size_t scan_whitespace(std::string_view text) noexcept
+{
+    return SCANNERS.whitespace(text.data(), text.data() + text.size());
+}
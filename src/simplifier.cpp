@@ -1,117 +1,1110 @@
 #include "simplifier.hpp"
 
-std::unique_ptr<expression> simplify(const expression_unary& unary);
-std::unique_ptr<expression> simplify(const expression_binary& binary);
-std::unique_ptr<expression> simplify(const expression_identifier& ident);
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "minimizer.hpp"
+
+namespace
+{
+expression_binary::kind flip(expression_binary::kind op)
+{
+    switch (op)
+    {
+    case expression_binary::kind::AND:
+        return expression_binary::kind::OR;
+
+    case expression_binary::kind::OR:
+        return expression_binary::kind::AND;
+    }
+
+    assert(!"Invalid binary operator");
+    return op;
+}
 
 /**
- * Simplifies the given expression as much as possible
+ * Folds <EXPR1> [AND/OR] <EXPR1> into <EXPR1> over the operands of a node
  *
- * The function implements the following rewrite rules:
- * * NOT(NOT(<EXPR>)) -> <EXPR>
- * * NOT(<EXPR1> AND <EXPR2>) -> NOT(<EXPR1>) OR NOT(<EXPR2>)
- * * NOT(<EXPR1> OR <EXPR2>) -> NOT(<EXPR1>) AND NOT(<EXPR2>)
- * * <EXPR1> [AND/OR] <EXPR1> -> <EXPR1>
+ * The operands are the last `count' entries of `done'. They stand for a
+ * right-nested chain, so they are folded from the right, exactly as the
+ * chain of two operand nodes would be, with the id of every suffix of the
+ * chain computed without building it.
  *
- * All rewrite rules are performed with recursive descent, from
- * left to right, as much as possible.
+ * If `sizes' is given, it is a stack of the node counts of `done', whose
+ * last `count' entries are replaced by the total node count of the
+ * operands that are left.
  *
- * @param expr The expression to simplify
- * @return Owning reference to simplified expression
+ * @param op The operator of the node
+ * @param done The stack of simplified expressions to take the operands from
+ * @param count The number of operands
+ * @param sizes The stack of node counts of `done', if tracked
+ * @return The operands that are left, in order
  */
-std::unique_ptr<expression> simplify(const expression& expr)
+expression_binary::operand_list fold_duplicates(
+    expression_binary::kind op,
+    std::vector<std::unique_ptr<expression>>& done,
+    std::size_t count,
+    std::vector<std::size_t>* sizes = nullptr)
 {
-    switch (expr.type())
+    expression_binary::operand_list kept;
+    std::size_t kept_size = 0;
+
+    const auto size_of = [sizes](std::size_t i) {
+        return sizes != nullptr ? (*sizes)[i] : 0;
+    };
+
+    auto id = done.back()->id();
+    kept.push_back(std::move(done.back()));
+    kept_size += size_of(done.size() - 1);
+
+    for (std::size_t i = 1; i < count; i++)
     {
-    case expression::type::IDENTIFIER:
+        const auto pos = done.size() - 1 - i;
+        auto& operand = done[pos];
+        if (operand->id() == id)
+        {
+            kept.clear();
+            kept_size = 0;
+        }
+        else
+        {
+            id = expression_binary::fold_id(op, operand->id(), id);
+        }
+        kept.push_back(std::move(operand));
+        kept_size += size_of(pos);
+    }
+
+    done.resize(done.size() - count);
+    if (sizes != nullptr)
     {
-        const auto& ident = dynamic_cast<const expression_identifier&>(expr);
-        return simplify(ident);
+        sizes->resize(sizes->size() - count);
+        sizes->push_back(kept_size);
     }
 
-    case expression::type::BINARY:
+    std::reverse(kept.begin(), kept.end());
+    return kept;
+}
+
+
+/**
+ * A subexpression of the result of `apply_set_rules'
+ *
+ * `key' identifies the expression up to the order of operands, and
+ * `operand_keys' holds the sorted keys of the operands of a binary node,
+ * whose own entries are kept in `parts' with their expressions moved into
+ * the node. A contradiction or tautology is an AND or OR of a literal and
+ * its negation, which is how the rules spell out FALSE and TRUE.
+ */
+struct set_entry
+{
+    enum class constant
+    {
+        NONE,
+        FALSE,
+        TRUE,
+    };
+
+    std::unique_ptr<expression> expr;
+    std::uint32_t key;
+    std::vector<std::uint32_t> operand_keys;
+    std::vector<set_entry> parts;
+    constant value;
+};
+
+set_entry make_leaf_entry(std::unique_ptr<expression> expr)
+{
+    const auto key = expr->id();
+    return {std::move(expr), key, {}, {}, set_entry::constant::NONE};
+}
+
+/**
+ * Builds the node for the given operands, keyed by the sorted keys of its
+ * operands
+ */
+set_entry make_node_entry(
+    expression_binary::kind op,
+    std::vector<set_entry> parts,
+    set_entry::constant value)
+{
+    std::vector<std::uint32_t> keys;
+    expression_binary::operand_list operands;
+    for (auto& part : parts)
     {
-        const auto& binary = dynamic_cast<const expression_binary&>(expr);
-        return simplify(binary);
+        keys.push_back(part.key);
+        operands.push_back(std::move(part.expr));
     }
+    std::sort(keys.begin(), keys.end());
+
+    auto key = keys.back();
+    for (auto i = keys.size() - 1; i-- > 0;)
+        key = expression_binary::fold_id(op, keys[i], key);
+
+    return {make_binary(op, std::move(operands)), key, std::move(keys), std::move(parts), value};
+}
+
+bool is_dual(const set_entry& entry, expression_binary::kind op)
+{
+    return entry.expr->type() == expression::type::BINARY
+        && static_cast<const expression_binary&>(*entry.expr).op() != op;
+}
+
+/**
+ * Returns the symbol of a literal and whether it is negated
+ */
+std::optional<std::pair<symbol_table::symbol, bool>> literal(const expression& expr)
+{
+    using result = std::optional<std::pair<symbol_table::symbol, bool>>;
+
+    return visit(
+        expr,
+        overloaded{
+            [](const expression_identifier& ident) -> result {
+                return std::pair(ident.symbol(), false);
+            },
+            [](const expression_unary& unary) -> result {
+                if (unary.inner().type() != expression::type::IDENTIFIER)
+                    return std::nullopt;
+                return std::pair(
+                    static_cast<const expression_identifier&>(unary.inner()).symbol(), true);
+            },
+            [](const expression_binary&) -> result { return std::nullopt; },
+        });
+}
 
-    case expression::type::UNARY:
+/**
+ * Applies idempotence, absorption and complement to the operands of a node
+ *
+ * Operands are compared by key, so that the rules hold up to the order
+ * of operands at every level, and survivors keep their order. With
+ * op the operator of the node and op' its dual:
+ * * <EXPR1> op <EXPR1> -> <EXPR1>, across the whole chain
+ * * <EXPR1> op (<EXPR1> op' <EXPR2>) -> <EXPR1>, and likewise for an op'
+ *   operand whose operands include all those of another op' operand
+ * * <LIT> op NOT(<LIT>) -> a contradiction for AND, a tautology for OR,
+ *   which absorbs the rest of the chain and is dropped from a chain of
+ *   the dual operator
+ *
+ * Duplicates are found by sorting keys, in O(n log n). Absorption
+ * between two op' operands is checked pairwise.
+ *
+ * @param op The operator of the node
+ * @param operands The entries of the operands, already simplified
+ * @return The entry of the simplified node
+ */
+set_entry reduce_set(expression_binary::kind op, std::vector<set_entry> operands)
+{
+    using constant = set_entry::constant;
+    using kind = expression_binary::kind;
+
+    const auto zero = op == kind::AND ? constant::FALSE : constant::TRUE;
+    const auto identity = op == kind::AND ? constant::TRUE : constant::FALSE;
+
+    // Associativity: operands of nested chains of `op' join this one
+    std::vector<set_entry> flat;
+    for (auto& entry : operands)
     {
-        const auto& unary = dynamic_cast<const expression_unary&>(expr);
-        return simplify(unary);
+        if (entry.expr->type() != expression::type::BINARY || is_dual(entry, op))
+        {
+            flat.push_back(std::move(entry));
+            continue;
+        }
+
+        auto nested = static_cast<expression_binary&>(*entry.expr).take_operands();
+        for (std::size_t i = 0; i < nested.size(); i++)
+        {
+            entry.parts[i].expr = std::move(nested[i]);
+            flat.push_back(std::move(entry.parts[i]));
+        }
     }
+
+    // Constants
+    for (auto& entry : flat)
+        if (entry.value == zero)
+            return std::move(entry);
+
+    std::vector<std::size_t> live;
+    for (std::size_t i = 0; i < flat.size(); i++)
+        if (flat[i].value != identity)
+            live.push_back(i);
+    if (live.empty())
+        return std::move(flat.front());
+
+    // Idempotence
+    std::vector<std::size_t> by_key = live;
+    std::stable_sort(by_key.begin(), by_key.end(), [&flat](auto l, auto r) {
+        return flat[l].key < flat[r].key;
+    });
+
+    std::vector<bool> dropped(flat.size(), false);
+    for (std::size_t i = 1; i < by_key.size(); i++)
+        if (flat[by_key[i]].key == flat[by_key[i - 1]].key)
+            dropped[by_key[i]] = true;
+
+    // Complement
+    std::unordered_map<symbol_table::symbol, std::pair<std::size_t, bool>> literals;
+    for (const auto i : live)
+    {
+        if (dropped[i])
+            continue;
+
+        const auto lit = literal(*flat[i].expr);
+        if (!lit.has_value())
+            continue;
+
+        const auto [it, inserted] = literals.try_emplace(lit->first, i, lit->second);
+        if (!inserted && it->second.second != lit->second)
+        {
+            std::vector<set_entry> pair;
+            pair.push_back(std::move(flat[it->second.first]));
+            pair.push_back(std::move(flat[i]));
+            return make_node_entry(op, std::move(pair), zero);
+        }
     }
+
+    // Absorption
+    std::unordered_set<std::uint32_t> plain;
+    std::vector<std::size_t> duals;
+    for (const auto i : live)
+    {
+        if (dropped[i])
+            continue;
+        if (is_dual(flat[i], op))
+            duals.push_back(i);
+        else
+            plain.insert(flat[i].key);
+    }
+
+    std::sort(duals.begin(), duals.end(), [&flat](auto l, auto r) {
+        return flat[l].operand_keys.size() < flat[r].operand_keys.size();
+    });
+
+    for (std::size_t i = 0; i < duals.size(); i++)
+    {
+        const auto& keys = flat[duals[i]].operand_keys;
+
+        bool absorbed = std::any_of(keys.begin(), keys.end(), [&plain](auto key) {
+            return plain.count(key) != 0;
+        });
+        for (std::size_t j = 0; j < i && !absorbed; j++)
+        {
+            const auto& smaller = flat[duals[j]].operand_keys;
+            absorbed = !dropped[duals[j]]
+                && std::includes(keys.begin(), keys.end(), smaller.begin(), smaller.end());
+        }
+
+        dropped[duals[i]] = absorbed;
+    }
+
+    std::vector<set_entry> kept;
+    for (const auto i : live)
+        if (!dropped[i])
+            kept.push_back(std::move(flat[i]));
+
+    if (kept.size() == 1)
+        return std::move(kept.front());
+
+    return make_node_entry(op, std::move(kept), constant::NONE);
 }
 
-std::unique_ptr<expression> simplify(const expression_unary& unary)
+/**
+ * Applies the set rules of `reduce_set' to every node of an expression in
+ * negation normal form, bottom up
+ *
+ * @param expr The expression, as returned by `to_nnf'
+ * @return Owning reference to the simplified expression
+ */
+std::unique_ptr<expression> apply_set_rules(std::unique_ptr<expression> expr)
 {
-    switch (unary.op())
+    struct frame
     {
-    case expression_unary::kind::NOT:
+        std::unique_ptr<expression> expr;
+        bool expanded;
+        std::size_t operands;
+    };
+
+    std::vector<frame> work;
+    work.push_back({std::move(expr), false, 0});
+    std::vector<set_entry> done;
+
+    while (!work.empty())
     {
-        auto simp_inner = simplify(unary.inner());
+        auto f = std::move(work.back());
+        work.pop_back();
 
-        switch (simp_inner->type())
+        if (f.expr->type() != expression::type::BINARY)
         {
-        case expression::type::UNARY:
+            done.push_back(make_leaf_entry(std::move(f.expr)));
+            continue;
+        }
+
+        auto& binary = static_cast<expression_binary&>(*f.expr);
+        if (!f.expanded)
         {
-            const auto& simp_unary = dynamic_cast<const expression_unary&>(*simp_inner);
-            switch (simp_unary.op())
-            {
-            case expression_unary::kind::NOT:
-                return simp_unary.inner().clone();
-            }
+            auto operands = binary.take_operands();
+            const auto count = operands.size();
+            work.push_back({std::move(f.expr), true, count});
+            for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                work.push_back({std::move(*it), false, 0});
+            continue;
+        }
+
+        const auto first = done.end() - static_cast<std::ptrdiff_t>(f.operands);
+        std::vector<set_entry> operands(
+            std::make_move_iterator(first), std::make_move_iterator(done.end()));
+        done.erase(first, done.end());
+
+        done.push_back(reduce_set(binary.op(), std::move(operands)));
+    }
+
+    assert(done.size() == 1);
+    return std::move(done.back().expr);
+}
+
+std::size_t leaf_count(const expression& expr)
+{
+    std::size_t count = 0;
+    std::vector<const expression*> work = {&expr};
+    while (!work.empty())
+    {
+        const auto* e = work.back();
+        work.pop_back();
+
+        visit(
+            *e,
+            overloaded{
+                [&](const expression_identifier&) { count++; },
+                [&](const expression_unary& unary) { work.push_back(&unary.inner()); },
+                [&](const expression_binary& binary) {
+                    for (const auto& operand : binary.operands())
+                        work.push_back(operand.get());
+                },
+            });
+    }
+    return count;
+}
+
+/**
+ * Returns the two-level minimization of `expr' if it has fewer leaves
+ * than `expr', and `expr' otherwise
+ *
+ * @param expr The expression, as returned by `apply_set_rules'
+ * @return Owning reference to the smaller expression
+ */
+std::unique_ptr<expression> minimize_if_smaller(std::unique_ptr<expression> expr)
+{
+    auto minimized = minimize(*expr);
+    if (minimized == nullptr || leaf_count(*minimized) >= leaf_count(*expr))
+        return expr;
+    return minimized;
+}
+
+/**
+ * Implements `to_nnf(const expression&, bool)', optionally with a cache
+ */
+std::unique_ptr<expression> nnf_copy(const expression& expr, bool negate, simplify_cache* cache)
+{
+    struct frame
+    {
+        const expression* expr;
+        bool negated;
+        bool expanded;
+    };
+
+    std::vector<frame> work = {{&expr, negate, false}};
+    std::vector<std::unique_ptr<expression>> done;
+    std::vector<std::size_t> sizes;
+
+    while (!work.empty())
+    {
+        const auto f = work.back();
+        work.pop_back();
+
+        visit(
+            *f.expr,
+            overloaded{
+                [&](const expression_identifier& ident) {
+                    auto copy = ident.clone();
+                    if (f.negated)
+                        copy = make_unary(expression_unary::kind::NOT, std::move(copy));
+                    done.push_back(std::move(copy));
+                    sizes.push_back(f.negated ? 2 : 1);
+                },
+                [&](const expression_unary& unary) {
+                    switch (unary.op())
+                    {
+                    case expression_unary::kind::NOT:
+                        work.push_back({&unary.inner(), !f.negated, false});
+                        break;
+                    }
+                },
+                [&](const expression_binary& binary) {
+                    const auto& operands = binary.operands();
+                    if (!f.expanded)
+                    {
+                        if (cache != nullptr)
+                        {
+                            if (const auto* hit = cache->find(binary.id(), f.negated))
+                            {
+                                done.push_back(hit->expr->clone());
+                                sizes.push_back(hit->nodes);
+                                return;
+                            }
+                        }
+
+                        work.push_back({f.expr, f.negated, true});
+                        for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                            work.push_back({it->get(), f.negated, false});
+                        return;
+                    }
+
+                    const auto op = f.negated ? flip(binary.op()) : binary.op();
+                    auto kept = fold_duplicates(op, done, operands.size(), &sizes);
+                    if (kept.size() == 1)
+                    {
+                        done.push_back(std::move(kept.front()));
+                    }
+                    else
+                    {
+                        done.push_back(make_binary(op, std::move(kept)));
+                        sizes.back()++;
+                    }
+
+                    if (cache != nullptr)
+                        cache->insert(binary.id(), f.negated, *done.back(), sizes.back());
+                },
+            });
+    }
+
+    assert(done.size() == 1);
+    return std::move(done.back());
+}
+
+/**
+ * Implements `to_nnf(const expression&, task_pool&, bool)'
+ *
+ * The AND/OR nodes of at least `cutoff' nodes are split up into tasks:
+ * each operand that is that large on its own, and each run of smaller
+ * consecutive operands of up to that size, is converted by a task of its
+ * own. Smaller subtrees are converted by `nnf_copy'.
+ *
+ * A split node is joined by whichever task converts its last operand,
+ * which folds the operands exactly as `nnf_copy' does and passes the node
+ * on to the node above. No task ever waits for another one.
+ */
+class parallel_nnf final
+{
+public:
+    parallel_nnf(task_pool& pool, std::size_t cutoff) noexcept
+        : pool_(pool)
+        , cutoff_(cutoff)
+        , result_()
+        , failed_(false)
+        , error_()
+    {
+    }
+
+    [[nodiscard]] std::unique_ptr<expression> run(const expression& expr, bool negate)
+    {
+        pool_.run([this, &expr, negate] { convert(expr, negate, nullptr, 0); });
+        if (error_ != nullptr)
+            std::rethrow_exception(error_);
+        return std::move(result_);
+    }
+
+private:
+    struct join
+    {
+        const expression_binary* binary;
+        bool negated;
+        std::vector<std::unique_ptr<expression>> operands;
+        std::atomic<std::size_t> pending;
+        join* parent;
+        std::size_t slot;
+    };
+
+    struct piece
+    {
+        std::size_t first;
+        std::size_t last;
+    };
+
+    task_pool& pool_;
+    std::size_t cutoff_;
+    std::unique_ptr<expression> result_;
+    std::atomic<bool> failed_;
+    std::exception_ptr error_;
+
+    // The operand of the NOTs on top of `expr', flipping `negated' once for
+    // each of them
+    static const expression& strip_nots(const expression& expr, bool& negated)
+    {
+        const auto* e = &expr;
+        for (;;)
+        {
+            const auto* inner = visit(
+                *e,
+                overloaded{
+                    [](const expression_unary& unary) { return &unary.inner(); },
+                    [](const auto&) -> const expression* { return nullptr; },
+                });
+            if (inner == nullptr)
+                return *e;
+
+            // NOT is the only unary operator
+            e = inner;
+            negated = !negated;
+        }
+    }
+
+    static const expression_binary* as_binary(const expression& expr)
+    {
+        return visit(
+            expr,
+            overloaded{
+                [](const expression_binary& binary) { return &binary; },
+                [](const auto&) -> const expression_binary* { return nullptr; },
+            });
+    }
+
+    /**
+     * Cuts the operands of `binary' into pieces: a single operand of at
+     * least `cutoff_' nodes, or a run of smaller consecutive ones of at
+     * most `cutoff_' nodes in total
+     */
+    template<typename Visitor>
+    void for_each_piece(const expression_binary& binary, Visitor&& visitor) const
+    {
+        const auto& operands = binary.operands();
+        for (std::size_t first = 0; first < operands.size();)
+        {
+            auto last = first + 1;
+            std::size_t run = operands[first]->nodes();
+            for (; run < cutoff_ && last < operands.size()
+                 && run + operands[last]->nodes() <= cutoff_;
+                 last++)
+                run += operands[last]->nodes();
+
+            visitor(first, last, run);
+            first = last;
         }
+    }
 
-        case expression::type::BINARY:
+    /**
+     * Returns how far down the chain of large operands from `binary' the
+     * first node that gives at least two tasks is, if there is one
+     */
+    std::optional<std::size_t> fork_depth(const expression_binary& binary) const
+    {
+        const auto* b = &binary;
+        for (std::size_t depth = 0;; depth++)
         {
-            const auto simp_binary = dynamic_cast<const expression_binary&>(*simp_inner);
-            auto& left = simp_binary.left();
-            auto& right = simp_binary.right();
+            std::size_t tasks = 0;
+            const expression* large = nullptr;
+            for_each_piece(*b, [&](auto first, auto, auto run) {
+                const auto* operand = b->operands()[first].get();
+                if (operand->nodes() >= cutoff_)
+                    large = operand;
+                if (operand->nodes() >= cutoff_ || 2 * run >= cutoff_)
+                    tasks++;
+            });
 
-            const auto neg_left = make_unary(expression_unary::kind::NOT, left.clone());
-            const auto neg_right = make_unary(expression_unary::kind::NOT, right.clone());
+            if (tasks >= 2)
+                return depth;
+            if (large == nullptr)
+                return std::nullopt;
 
-            auto simp_left = simplify(*neg_left);
-            auto simp_right = simplify(*neg_right);
+            bool negated = false;
+            b = as_binary(strip_nots(*large, negated));
+            if (b == nullptr || b->nodes() < cutoff_)
+                return std::nullopt;
+        }
+    }
 
-            switch (simp_binary.op())
+    /**
+     * Converts `expr' and delivers the result to operand `slot' of
+     * `parent'
+     *
+     * Large operands are spawned as tasks, except the last one, which is
+     * converted next by the same call, and runs of smaller operands too
+     * short to pay for a task of their own are converted right away. A
+     * deep and narrow tree is converted by `nnf_copy' down to its first
+     * fork, and entirely if it has none.
+     *
+     * Nothing is thrown: once anything fails, every operand still to be
+     * converted is delivered empty, so that every join is still freed.
+     */
+    void convert(const expression& expr, bool negated, join* parent, std::size_t slot) noexcept
+    {
+        // Levels left down to the last fork found, this one included
+        std::size_t levels = 0;
+        for (const auto* e = &expr; e != nullptr; levels--)
+        {
+            if (failed_.load(std::memory_order_relaxed))
             {
-            case expression_binary::kind::AND:
-                return make_binary(
-                    expression_binary::kind::OR, std::move(simp_left), std::move(simp_right));
+                deliver(nullptr, parent, slot);
+                return;
+            }
 
-            case expression_binary::kind::OR:
-                return make_binary(
-                    expression_binary::kind::AND, std::move(simp_left), std::move(simp_right));
+            e = &strip_nots(*e, negated);
+            const auto* binary = as_binary(*e);
+            if (binary != nullptr && binary->nodes() >= cutoff_ && levels == 0)
+            {
+                if (const auto depth = fork_depth(*binary))
+                    levels = *depth + 1;
             }
+            if (binary == nullptr || binary->nodes() < cutoff_ || levels == 0)
+            {
+                deliver_copy(*e, negated, parent, slot);
+                return;
+            }
+
+            e = split(*binary, negated, parent, slot);
         }
+    }
+
+    /**
+     * Hands out the operands of `binary' to a new join
+     *
+     * @return The last large operand, left for the caller to convert with
+     * `parent' and `slot' now naming its place in the join, or `nullptr'
+     */
+    const expression*
+    split(const expression_binary& binary, bool negated, join*& parent, std::size_t& slot) noexcept
+    {
+        const auto& operands = binary.operands();
+        std::unique_ptr<join> node;
+        std::vector<piece> tasks;
+        std::vector<piece> inline_runs;
+        std::optional<std::size_t> next;
+        try
+        {
+            node.reset(new join{
+                &binary,
+                negated,
+                std::vector<std::unique_ptr<expression>>(operands.size()),
+                {operands.size()},
+                parent,
+                slot});
+
+            for_each_piece(binary, [&](auto first, auto last, auto run) {
+                if (operands[first]->nodes() >= cutoff_)
+                {
+                    if (next.has_value())
+                        tasks.push_back({*next, *next + 1});
+                    next = first;
+                }
+                else if (2 * run >= cutoff_)
+                    tasks.push_back({first, last});
+                else
+                    inline_runs.push_back({first, last});
+            });
+        }
+        catch (...)
+        {
+            fail();
+            deliver(nullptr, parent, slot);
+            return nullptr;
+        }
+
+        // From here on the operands of the join complete it
+        auto* shared = node.release();
+        auto spawned = tasks.size();
+        for (std::size_t t = 0; t < tasks.size(); t++)
+        {
+            try
+            {
+                spawn(shared, tasks[t]);
+            }
+            catch (...)
+            {
+                fail();
+                spawned = t;
+                break;
+            }
+        }
+
+        for (auto t = spawned; t < tasks.size(); t++)
+            for (auto i = tasks[t].first; i < tasks[t].last; i++)
+                deliver(nullptr, shared, i);
+        for (const auto& [first, last] : inline_runs)
+            for (auto i = first; i < last; i++)
+                deliver_copy(*operands[i], negated, shared, i);
+
+        if (!next.has_value())
+            return nullptr;
+
+        parent = shared;
+        slot = *next;
+        return operands[*next].get();
+    }
+
+    void spawn(join* node, piece range)
+    {
+        pool_.spawn([this, node, range] {
+            for (auto i = range.first; i < range.last; i++)
+                convert(*node->binary->operands()[i], node->negated, node, i);
+        });
+    }
 
-        case expression::type::IDENTIFIER:
+    void fail() noexcept
+    {
+        if (!failed_.exchange(true))
+            error_ = std::current_exception();
+    }
+
+    void deliver_copy(const expression& expr, bool negated, join* parent, std::size_t slot) noexcept
+    {
+        std::unique_ptr<expression> copy;
+        if (!failed_.load(std::memory_order_relaxed))
         {
-            return make_unary(expression_unary::kind::NOT, std::move(simp_inner));
+            try
+            {
+                copy = nnf_copy(expr, negated, nullptr);
+            }
+            catch (...)
+            {
+                fail();
+            }
         }
+        deliver(std::move(copy), parent, slot);
+    }
+
+    void deliver(std::unique_ptr<expression> expr, join* parent, std::size_t slot) noexcept
+    {
+        while (parent != nullptr)
+        {
+            parent->operands[slot] = std::move(expr);
+            if (parent->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                return;
+
+            const std::unique_ptr<join> done(parent);
+            if (!failed_.load(std::memory_order_relaxed))
+            {
+                try
+                {
+                    const auto op = done->negated ? flip(done->binary->op()) : done->binary->op();
+                    auto kept = fold_duplicates(op, done->operands, done->operands.size());
+                    if (kept.size() == 1)
+                        expr = std::move(kept.front());
+                    else
+                        expr = make_binary(op, std::move(kept));
+                }
+                catch (...)
+                {
+                    fail();
+                }
+            }
+
+            parent = done->parent;
+            slot = done->slot;
         }
+
+        result_ = std::move(expr);
     }
+};
+} // namespace
+
+/**
+ * Simplifies the given expression as much as possible
+ *
+ * The function implements the following rewrite rules:
+ * * NOT(NOT(<EXPR>)) -> <EXPR>
+ * * NOT(<EXPR1> AND <EXPR2>) -> NOT(<EXPR1>) OR NOT(<EXPR2>)
+ * * NOT(<EXPR1> OR <EXPR2>) -> NOT(<EXPR1>) AND NOT(<EXPR2>)
+ * * <EXPR1> [AND/OR] <EXPR1> -> <EXPR1>
+ *
+ * The last rule compares the operands once they are simplified, so
+ * ((b AND b) AND c) AND (b AND c) folds to b AND c.
+ *
+ * Applied from left to right as much as possible, these rules push every
+ * NOT down onto an identifier, so the result is the negation normal form
+ * computed by `to_nnf'.
+ *
+ * At `simplify_level::ALGEBRAIC', AND and OR are further treated as
+ * associative and commutative, and duplicate operands anywhere in a
+ * chain, absorption (<EXPR1> OR (<EXPR1> AND <EXPR2>) -> <EXPR1>) and
+ * complementary literals are simplified as well.
+ *
+ * At `simplify_level::MINIMIZE', the result of `simplify_level::ALGEBRAIC'
+ * is replaced by its two-level minimization computed by `minimize' when
+ * that has fewer leaves, which also merges terms such as
+ * (<EXPR1> AND <EXPR2>) OR (<EXPR1> AND NOT(<EXPR2>)) -> <EXPR1>.
+ *
+ * @param expr The expression to simplify
+ * @param level The rules to apply
+ * @return Owning reference to simplified expression
+ */
+std::unique_ptr<expression> simplify(const expression& expr, simplify_level level)
+{
+    switch (level)
+    {
+    case simplify_level::REWRITE:
+        return to_nnf(expr);
+
+    case simplify_level::ALGEBRAIC:
+        return apply_set_rules(to_nnf(expr));
+
+    case simplify_level::MINIMIZE:
+        return minimize_if_smaller(apply_set_rules(to_nnf(expr)));
     }
+
+    assert(!"Invalid simplification level");
+    return nullptr;
+}
+
+/**
+ * Converts the given expression, or its negation, to negation normal form
+ *
+ * Every NOT is pushed down onto an identifier with De Morgan's laws, and
+ * double negations cancel out. <EXPR1> [AND/OR] <EXPR1> is folded into
+ * <EXPR1> on the way up, as `simplify' does.
+ *
+ * The tree is walked once in post-order with the number of enclosing
+ * NOTs carried along as a polarity bit, so every node is visited once
+ * and every node of the result is allocated once. The walk keeps its
+ * state in explicit stacks on the heap, bounded by the depth of the tree.
+ *
+ * @param expr The expression to convert
+ * @param negate Whether to convert NOT(<EXPR>) rather than <EXPR>
+ * @return Owning reference to the converted expression
+ */
+std::unique_ptr<expression> to_nnf(const expression& expr, bool negate)
+{
+    return nnf_copy(expr, negate, nullptr);
 }
 
-std::unique_ptr<expression> simplify(const expression_binary& binary)
+/**
+ * Converts the given expression, or its negation, to negation normal form,
+ * reusing results from `cache'
+ *
+ * Every AND/OR node is looked up in `cache' before it is walked, and its
+ * result is added to `cache' once it has been converted. The cache can be
+ * shared by any number of calls.
+ *
+ * @param expr The expression to convert
+ * @param cache The cache of converted subexpressions
+ * @param negate Whether to convert NOT(<EXPR>) rather than <EXPR>
+ * @return Owning reference to the converted expression
+ */
+std::unique_ptr<expression> to_nnf(const expression& expr, simplify_cache& cache, bool negate)
 {
-    auto simp_left = simplify(binary.left());
-    auto simp_right = simplify(binary.right());
+    return nnf_copy(expr, negate, &cache);
+}
 
-    if (*simp_left == *simp_right)
+/**
+ * Converts the given expression, or its negation, to negation normal form
+ * on the threads of `pool'
+ *
+ * The result is the same as that of `to_nnf(const expression&, bool)'.
+ * Subtrees of fewer than `SIMPLIFY_PARALLEL_CUTOFF' nodes are converted
+ * sequentially, so that tasks stay large enough to pay for themselves.
+ * Nodes of the result are allocated on the heap rather than in the
+ * current arena, which cannot be shared between threads. If converting
+ * a subtree throws, the other tasks stop early, every partial result is
+ * freed and the first exception is rethrown.
+ *
+ * @param expr The expression to convert
+ * @param pool The threads to convert the expression on
+ * @param negate Whether to convert NOT(<EXPR>) rather than <EXPR>
+ * @return Owning reference to the converted expression
+ */
+std::unique_ptr<expression> to_nnf(const expression& expr, task_pool& pool, bool negate)
+{
+    const arena_scope scope(nullptr);
+    parallel_nnf walk(pool, SIMPLIFY_PARALLEL_CUTOFF);
+    return walk.run(expr, negate);
+}
+
+/**
+ * Simplifies the given expression, reusing results from `cache'
+ *
+ * @see to_nnf(const expression&, simplify_cache&, bool)
+ * @param expr The expression to simplify
+ * @param cache The cache of simplified subexpressions
+ * @param level The rules to apply
+ * @return Owning reference to simplified expression
+ */
+std::unique_ptr<expression>
+simplify(const expression& expr, simplify_cache& cache, simplify_level level)
+{
+    switch (level)
     {
-        return simp_left;
+    case simplify_level::REWRITE:
+        return to_nnf(expr, cache);
+
+    case simplify_level::ALGEBRAIC:
+        return apply_set_rules(to_nnf(expr, cache));
+
+    case simplify_level::MINIMIZE:
+        return minimize_if_smaller(apply_set_rules(to_nnf(expr, cache)));
     }
-    else
+
+    assert(!"Invalid simplification level");
+    return nullptr;
+}
+
+/**
+ * Simplifies the given expression, converting it to negation normal form
+ * on the threads of `pool'
+ *
+ * The result is the same as that of `simplify(const expression&)'. The
+ * rules of `simplify_level::ALGEBRAIC' and `simplify_level::MINIMIZE' are
+ * then applied on the calling thread.
+ *
+ * @see to_nnf(const expression&, task_pool&, bool)
+ * @param expr The expression to simplify
+ * @param pool The threads to simplify the expression on
+ * @param level The rules to apply
+ * @return Owning reference to simplified expression
+ */
+std::unique_ptr<expression>
+simplify(const expression& expr, task_pool& pool, simplify_level level)
+{
+    switch (level)
     {
-        return binary.clone();
+    case simplify_level::REWRITE:
+        return to_nnf(expr, pool);
+
+    case simplify_level::ALGEBRAIC:
+        return apply_set_rules(to_nnf(expr, pool));
+
+    case simplify_level::MINIMIZE:
+        return minimize_if_smaller(apply_set_rules(to_nnf(expr, pool)));
+    }
+
+    assert(!"Invalid simplification level");
+    return nullptr;
+}
+
+/**
+ * Simplifies the given expression, allocating every node in `arena'
+ *
+ * @param expr The expression to simplify
+ * @param arena The arena owning the nodes of the simplified expression
+ * @param level The rules to apply
+ * @return Owning reference to simplified expression
+ */
+std::unique_ptr<expression>
+simplify(const expression& expr, expression_arena& arena, simplify_level level)
+{
+    const arena_scope scope(arena);
+    return simplify(expr, level);
+}
+
+
+/**
+ * Simplifies the given expression in place
+ *
+ * Implements the same rewrite rules as `simplify(const expression&)', but
+ * takes ownership of `expr' and rebuilds the result out of its nodes.
+ *
+ * @param expr The expression to simplify
+ * @param level The rules to apply
+ * @return Owning reference to simplified expression
+ */
+std::unique_ptr<expression> simplify(std::unique_ptr<expression>&& expr, simplify_level level)
+{
+    switch (level)
+    {
+    case simplify_level::REWRITE:
+        return to_nnf(std::move(expr));
+
+    case simplify_level::ALGEBRAIC:
+        return apply_set_rules(to_nnf(std::move(expr)));
+
+    case simplify_level::MINIMIZE:
+        return minimize_if_smaller(apply_set_rules(to_nnf(std::move(expr))));
     }
+
+    assert(!"Invalid simplification level");
+    return nullptr;
 }
 
-std::unique_ptr<expression> simplify(const expression_identifier& ident)
+/**
+ * Converts the given expression, or its negation, to negation normal form
+ * in place
+ *
+ * Performs the same walk as `to_nnf(const expression&, bool)', but takes
+ * ownership of `expr' and rebuilds the result out of its nodes. A new
+ * node is only allocated when a negation has to be pushed onto an
+ * identifier that does not already have a NOT node to reuse.
+ *
+ * @param expr The expression to convert
+ * @param negate Whether to convert NOT(<EXPR>) rather than <EXPR>
+ * @return Owning reference to the converted expression
+ */
+std::unique_ptr<expression> to_nnf(std::unique_ptr<expression>&& expr, bool negate)
 {
-    return ident.clone();
+    struct frame
+    {
+        std::unique_ptr<expression> expr;
+        bool negated;
+        bool expanded;
+        std::size_t operands;
+    };
+
+    std::vector<frame> work;
+    work.push_back({std::move(expr), negate, false, 0});
+    std::vector<std::unique_ptr<expression>> done;
+
+    while (!work.empty())
+    {
+        auto f = std::move(work.back());
+        work.pop_back();
+
+        // The visitors move `f.expr' on, which keeps the node alive
+        visit(
+            *f.expr,
+            overloaded{
+                [&](expression_identifier&) {
+                    if (f.negated)
+                        f.expr = make_unary(expression_unary::kind::NOT, std::move(f.expr));
+                    done.push_back(std::move(f.expr));
+                },
+                [&](expression_unary& unary) {
+                    switch (unary.op())
+                    {
+                    case expression_unary::kind::NOT:
+                        if (!f.negated && unary.inner().type() == expression::type::IDENTIFIER)
+                            done.push_back(std::move(f.expr));
+                        else
+                            work.push_back({unary.take_inner(), !f.negated, false, 0});
+                        break;
+                    }
+                },
+                [&](expression_binary& binary) {
+                    if (!f.expanded)
+                    {
+                        auto operands = binary.take_operands();
+                        const auto count = operands.size();
+                        work.push_back({std::move(f.expr), f.negated, true, count});
+                        for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                            work.push_back({std::move(*it), f.negated, false, 0});
+                        return;
+                    }
+
+                    const auto op = f.negated ? flip(binary.op()) : binary.op();
+                    auto kept = fold_duplicates(op, done, f.operands);
+                    if (kept.size() == 1)
+                    {
+                        done.push_back(std::move(kept.front()));
+                    }
+                    else
+                    {
+                        binary.assign(op, std::move(kept));
+                        done.push_back(std::move(f.expr));
+                    }
+                },
+            });
+    }
+
+    assert(done.size() == 1);
+    return std::move(done.back());
 }
@@ -0,0 +1,145 @@
+#include "simplify_cache.hpp"
+
+#include "arena.hpp"
+#include "expression_table.hpp"
+
+simplify_cache::simplify_cache(std::size_t capacity, std::size_t max_entry_nodes)
+    : capacity_(capacity)
+    , max_entry_nodes_(max_entry_nodes)
+    , entries_()
+    , index_()
+    , seen_()
+    , hits_(0)
+    , misses_(0)
+    , generation_(expression_table::instance().generation())
+{
+    index_.reserve(capacity_);
+}
+
+/**
+ * Looks up the simplified form of an expression
+ *
+ * Expressions are keyed by their hash-consed id, which is equal for two
+ * expressions if and only if they are structurally equal, so a hit needs
+ * no further comparison. A hit makes the entry the most recently used.
+ * The cache drops every entry first if `expression_table' has been
+ * cleared since it was last used, as the ids it holds may have been
+ * handed out again to other expressions.
+ *
+ * @param id Id of the expression
+ * @param negated Whether the simplified form of NOT(<EXPR>) is wanted
+ * @return The cached result, valid until the next insertion, or `nullptr'
+ */
+const simplify_cache::result* simplify_cache::find(std::uint32_t id, bool negated)
+{
+    check_generation();
+
+    const auto it = index_.find(key(id, negated));
+    if (it == index_.end())
+    {
+        misses_++;
+        return nullptr;
+    }
+
+    hits_++;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->value;
+}
+
+/**
+ * Caches the simplified form of an expression
+ *
+ * The cache keeps its own copy of `expr', allocated from the global heap
+ * so that it outlives any arena `expr' lives in. Results of more than
+ * `max_entry_nodes' nodes are not cached, which bounds the cost of
+ * copying them in and out. A result is only copied in the second time it
+ * is inserted, so that expressions that never repeat do not churn the
+ * cache. The least recently used entry is evicted when the cache is full.
+ *
+ * @param id Id of the expression that was simplified
+ * @param negated Whether `expr' is the simplified form of NOT(<EXPR>)
+ * @param expr The simplified expression
+ * @param nodes Number of nodes of `expr'
+ */
+void simplify_cache::insert(
+    std::uint32_t id,
+    bool negated,
+    const expression& expr,
+    std::size_t nodes)
+{
+    check_generation();
+    if (capacity_ == 0 || nodes > max_entry_nodes_)
+        return;
+
+    const auto k = key(id, negated);
+    if (index_.count(k) != 0)
+        return;
+
+    // Only results seen before are worth copying in
+    if (seen_.size() >= SEEN_FACTOR * capacity_)
+        seen_.clear();
+    if (seen_.insert(k).second)
+        return;
+
+    if (entries_.size() == capacity_)
+    {
+        index_.erase(entries_.back().key);
+        entries_.pop_back();
+    }
+
+    const arena_scope scope(nullptr);
+    entries_.push_front({k, {expr.clone(), nodes}});
+    index_.emplace(k, entries_.begin());
+}
+
+/**
+ * Drops every entry
+ *
+ * The hit and miss counters are kept.
+ */
+void simplify_cache::clear() noexcept
+{
+    index_.clear();
+    entries_.clear();
+    seen_.clear();
+}
+
+std::size_t simplify_cache::size() const noexcept
+{
+    return entries_.size();
+}
+
+const std::size_t& simplify_cache::capacity() const noexcept
+{
+    return capacity_;
+}
+
+const std::size_t& simplify_cache::max_entry_nodes() const noexcept
+{
+    return max_entry_nodes_;
+}
+
+const std::size_t& simplify_cache::hits() const noexcept
+{
+    return hits_;
+}
+
+const std::size_t& simplify_cache::misses() const noexcept
+{
+    return misses_;
+}
+
+void simplify_cache::check_generation() noexcept
+{
+    const auto generation = expression_table::instance().generation();
+    if (generation == generation_)
+        return;
+
+    clear();
+    generation_ = generation;
+}
+
+std::uint64_t simplify_cache::key(std::uint32_t id, bool negated) noexcept
+{
+    return static_cast<std::uint64_t>(id) << 1 | static_cast<std::uint64_t>(negated);
+}
@@ -0,0 +1,66 @@
+#include "symbol_table.hpp"
+
+#include <cassert>
+
+#include <mutex>
+
+symbol_table::symbol_table() noexcept
+    : mutex_()
+    , names_()
+    , index_()
+{
+}
+
+/**
+ * Maps a name to its symbol, adding it to the table if necessary
+ *
+ * Symbols are dense and handed out in order of first appearance,
+ * starting from 0.
+ *
+ * @param name The name to intern
+ * @return The symbol of the name
+ */
+symbol_table::symbol symbol_table::intern(std::string_view name)
+{
+    {
+        const std::shared_lock lock(mutex_);
+        if (const auto it = index_.find(name); it != index_.end())
+            return it->second;
+    }
+
+    const std::unique_lock lock(mutex_);
+    if (const auto it = index_.find(name); it != index_.end())
+        return it->second;
+
+    const auto sym = static_cast<symbol>(names_.size());
+    const auto& stored = names_.emplace_back(name);
+    index_.emplace(stored, sym);
+    return sym;
+}
+
+/**
+ * Resolves a symbol back to its name
+ *
+ * The returned reference stays valid for the lifetime of the program.
+ *
+ * @param sym A symbol previously returned by `intern'
+ * @return The name of the symbol
+ */
+const std::string& symbol_table::name(symbol sym) const
+{
+    const std::shared_lock lock(mutex_);
+    assert(sym < names_.size());
+    return names_[sym];
+}
+
+std::size_t symbol_table::size() const
+{
+    const std::shared_lock lock(mutex_);
+    return names_.size();
+}
+
+symbol_table& symbol_table::instance() noexcept
+{
+    static symbol_table table;
+    return table;
+}
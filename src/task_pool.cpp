@@ -0,0 +1,250 @@
+#include "task_pool.hpp"
+
+#include <cassert>
+
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+// An idle worker yields this many times before it goes to sleep
+constexpr std::size_t IDLE_SPINS = 64;
+
+struct worker_slot
+{
+    const task_pool* pool;
+    std::size_t index;
+};
+
+thread_local worker_slot current_worker = {nullptr, 0};
+} // namespace
+
+task_pool::task_pool(std::size_t workers)
+    : queues_(std::make_unique<queue[]>(std::max<std::size_t>(workers, 1)))
+    , workers_(std::max<std::size_t>(workers, 1))
+    , threads_()
+    , mutex_()
+    , start_()
+    , idle_()
+    , generation_(0)
+    , stopping_(false)
+    , error_()
+    , pending_(0)
+    , sleepers_(0)
+{
+    for (std::size_t index = 1; index < workers_; index++)
+        threads_.emplace_back([this, index] { work(index); });
+}
+
+task_pool::~task_pool()
+{
+    {
+        const std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    start_.notify_all();
+
+    for (auto& thread : threads_)
+        thread.join();
+}
+
+/**
+ * Runs `root' and every task it spawns, directly or not, to completion
+ *
+ * The calling thread works as the first worker until then. Tasks are
+ * taken from the back of a worker's own queue, so that it keeps working
+ * on the subtasks it has just spawned, and stolen from the front of the
+ * queues of the others, where the oldest and usually largest tasks are.
+ * Workers that find nothing to do sleep until a task is spawned.
+ *
+ * If tasks throw, every other task still runs, and the first exception
+ * is rethrown once they are all done.
+ *
+ * @param root The first task
+ */
+void task_pool::run(task root)
+{
+    assert(current_worker.pool == nullptr);
+
+    pending_.store(1, std::memory_order_relaxed);
+    {
+        const std::lock_guard lock(queues_[0].mutex);
+        queues_[0].tasks.push_back(std::move(root));
+    }
+
+    {
+        const std::lock_guard lock(mutex_);
+        generation_++;
+    }
+    start_.notify_all();
+
+    current_worker = {this, 0};
+    help(0);
+    current_worker = {nullptr, 0};
+
+    std::exception_ptr error;
+    {
+        const std::lock_guard lock(mutex_);
+        error = std::exchange(error_, nullptr);
+    }
+    if (error != nullptr)
+        std::rethrow_exception(error);
+}
+
+/**
+ * Adds a task to the queue of the calling worker
+ *
+ * May only be called from a task running in this pool, which `run' then
+ * waits for as well.
+ *
+ * @param t The task
+ */
+void task_pool::spawn(task t)
+{
+    assert(current_worker.pool == this);
+
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    {
+        auto& q = queues_[current_worker.index];
+        const std::lock_guard lock(q.mutex);
+        q.tasks.push_back(std::move(t));
+    }
+    wake(false);
+}
+
+std::size_t task_pool::workers() const noexcept
+{
+    return workers_;
+}
+
+std::size_t task_pool::default_workers() noexcept
+{
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+void task_pool::work(std::size_t index)
+{
+    current_worker = {this, index};
+
+    for (std::size_t seen = 0;;)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            start_.wait(lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_)
+                return;
+            seen = generation_;
+        }
+
+        help(index);
+    }
+}
+
+void task_pool::help(std::size_t index)
+{
+    task t;
+    for (std::size_t idle = 0; pending_.load() != 0;)
+    {
+        if (pop(index, t) || steal(index, t))
+        {
+            idle = 0;
+            execute(t);
+        }
+        else if (++idle < IDLE_SPINS)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            idle = 0;
+            park();
+        }
+    }
+}
+
+/**
+ * Runs `t', keeping the first exception thrown by a task for `run'
+ */
+void task_pool::execute(task& t)
+{
+    try
+    {
+        t();
+    }
+    catch (...)
+    {
+        const std::lock_guard lock(mutex_);
+        if (error_ == nullptr)
+            error_ = std::current_exception();
+    }
+    t = nullptr;
+
+    if (pending_.fetch_sub(1) == 1)
+        wake(true);
+}
+
+/**
+ * Sleeps until a task is spawned or the last one is done
+ *
+ * `sleepers_' is raised before the queues are checked, and read by
+ * `wake' after a task is queued or `pending_' drops, so that either the
+ * sleeper sees the change or `wake' sees the sleeper.
+ */
+void task_pool::park()
+{
+    std::unique_lock lock(mutex_);
+    sleepers_++;
+    idle_.wait(lock, [this] { return pending_.load() == 0 || has_work(); });
+    sleepers_--;
+}
+
+void task_pool::wake(bool all)
+{
+    if (sleepers_.load() == 0)
+        return;
+
+    const std::lock_guard lock(mutex_);
+    if (all)
+        idle_.notify_all();
+    else
+        idle_.notify_one();
+}
+
+bool task_pool::has_work()
+{
+    for (std::size_t i = 0; i < workers_; i++)
+    {
+        const std::lock_guard lock(queues_[i].mutex);
+        if (!queues_[i].tasks.empty())
+            return true;
+    }
+    return false;
+}
+
+bool task_pool::pop(std::size_t index, task& t)
+{
+    auto& q = queues_[index];
+    const std::lock_guard lock(q.mutex);
+    if (q.tasks.empty())
+        return false;
+
+    t = std::move(q.tasks.back());
+    q.tasks.pop_back();
+    return true;
+}
+
+bool task_pool::steal(std::size_t index, task& t)
+{
+    for (std::size_t i = 1; i < workers_; i++)
+    {
+        auto& q = queues_[(index + i) % workers_];
+        const std::lock_guard lock(q.mutex);
+        if (q.tasks.empty())
+            continue;
+
+        t = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        return true;
+    }
+    return false;
+}
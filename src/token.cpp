@@ -1,84 +1,71 @@
 #include "token.hpp"
 
-#include <utility>
-
 #include <fmt/format.h>
 
-token::token(location loc) noexcept
-    : loc_(loc)
-{
-}
-
-const location& token::loc() const noexcept
-{
-    return loc_;
-}
-
-
-token_error::token_error(location loc) noexcept
-    : token(loc)
+token::token(enum type type, location loc, std::string_view text, enum kind kind) noexcept
+    : type_(type)
+    , loc_(loc)
+    , text_(text)
+    , kind_(kind)
 {
 }
 
-enum token::type token_error::type() const noexcept
+const enum token::type& token::type() const noexcept
 {
-    return type::ERROR;
+    return type_;
 }
 
-
-token_identifier::token_identifier(location loc, std::string name)
-    : token(loc)
-    , name_(std::move(name))
+const location& token::loc() const noexcept
 {
+    return loc_;
 }
 
-const std::string& token_identifier::name() const
+/**
+ * Returns the text of the token
+ *
+ * The text is a view into the buffer of the lexer, and is only valid
+ * until the lexer is asked for the next token.
+ *
+ * @return The text of the token
+ */
+const std::string_view& token::text() const noexcept
 {
-    return name_;
+    return text_;
 }
 
-enum token::type token_identifier::type() const noexcept
+const enum token::kind& token::kind() const noexcept
 {
-    return type::IDENTIFIER;
+    return kind_;
 }
 
 
-token_operator::token_operator(location loc, enum kind k) noexcept
-    : token(loc)
-    , kind_(k)
+token make_error_token(location loc) noexcept
 {
+    return token(token::type::ERROR, loc, {}, token::kind::NONE);
 }
 
-const enum token_operator::kind& token_operator::kind() const
+token make_identifier_token(location loc, std::string_view name) noexcept
 {
-    return kind_;
+    return token(token::type::IDENTIFIER, loc, name, token::kind::NONE);
 }
 
-enum token::type token_operator::type() const noexcept
+token make_operator_token(location loc, std::string_view text, enum token::kind kind) noexcept
 {
-    return type::OPERATOR;
+    return token(token::type::OPERATOR, loc, text, kind);
 }
 
-
-token_end::token_end(location loc) noexcept
-    : token(loc)
+token make_separator_token(location loc, std::string_view text) noexcept
 {
+    return token(token::type::SEPARATOR, loc, text, token::kind::NONE);
 }
 
-enum token::type token_end::type() const noexcept
+token make_end_token(location loc) noexcept
 {
-    return type::END;
+    return token(token::type::END, loc, {}, token::kind::NONE);
 }
 
 
-const token_operator* match_operator_kind(const token& tok, enum token_operator::kind kind)
+bool match_operator_kind(const token& tok, enum token::kind kind) noexcept
 {
-    const auto op = dynamic_cast<const token_operator*>(&tok);
-    if (op == nullptr)
-        return nullptr;
-
-    if (op->kind() != kind)
-        return nullptr;
-
-    return op;
+    return tok.type() == token::type::OPERATOR && tok.kind() == kind;
 }
@@ -0,0 +1,123 @@
+#include <cstdlib>
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "bdd.hpp"
+#include "expression.hpp"
+#include "input_source.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "symbol_table.hpp"
+
+namespace
+{
+using binary_kind = expression_binary::kind;
+
+int failures = 0;
+
+void check(bool condition, std::string_view what)
+{
+    if (condition)
+        return;
+
+    std::cerr << fmt::format("FAILED: {}\n", what);
+    failures++;
+}
+
+std::unique_ptr<expression> parse(std::string_view text)
+{
+    input_string in(text);
+    lexer lex(in);
+    parser par(lex);
+    return par.parse_expression();
+}
+
+/**
+ * Checks that the diagram of `text' comes back as an equivalent
+ * expression of exactly `nodes' nodes
+ */
+void check_round_trip(std::string_view text, std::size_t nodes)
+{
+    bdd_manager manager;
+    const auto expr = parse(text);
+    const auto f = manager.from_expression(*expr);
+    const auto extracted = manager.to_expression(f);
+
+    check(extracted != nullptr, fmt::format("`{}' is extracted", text));
+    if (extracted == nullptr)
+        return;
+
+    check(manager.from_expression(*extracted) == f, fmt::format("`{}' is preserved", text));
+    check(
+        extracted->nodes() == nodes,
+        fmt::format("`{}' comes back as `{}' of {} nodes", text, *extracted, nodes));
+}
+
+/**
+ * The consensus term b AND c is redundant, so only the two others are
+ * left, which is the minimal sum of products
+ */
+void test_consensus()
+{
+    check_round_trip("(a && b) || (!a && c)", 8);
+    check_round_trip("(a && b) || (!a && c) || (b && c)", 8);
+}
+
+/**
+ * (a0 AND b0) OR ... OR (a39 AND b39) has a diagram of 80 nodes, and
+ * its 40 cubes are already minimal
+ */
+void test_wide_or()
+{
+    bdd_manager manager;
+    std::unique_ptr<expression> expr;
+    for (std::size_t i = 0; i < 40; i++)
+    {
+        std::unique_ptr<expression> term = make_binary(
+            binary_kind::AND,
+            make_identifier(fmt::format("a{}", i)),
+            make_identifier(fmt::format("b{}", i)));
+        expr = expr == nullptr ? std::move(term)
+                               : make_binary(binary_kind::OR, std::move(term), std::move(expr));
+    }
+
+    const auto f = manager.from_expression(*expr);
+    check(manager.count_nodes(f) == 80, "the 40 pairs have a diagram of 80 nodes");
+
+    const auto extracted = manager.to_expression(f);
+    check(extracted != nullptr, "the 40 pairs are extracted");
+    if (extracted == nullptr)
+        return;
+
+    check(manager.from_expression(*extracted) == f, "the 40 pairs are preserved");
+    check(extracted->nodes() == expr->nodes(), "the 40 pairs come back as 40 cubes");
+}
+
+void test_constants()
+{
+    bdd_manager manager;
+    check(manager.to_expression(manager.constant(true)) == nullptr, "TRUE needs a variable");
+
+    (void)manager.variable_of(symbol_table::instance().intern("a"));
+    for (const auto value : {false, true})
+    {
+        const auto f = manager.constant(value);
+        const auto extracted = manager.to_expression(f);
+        check(
+            extracted != nullptr && manager.from_expression(*extracted) == f,
+            fmt::format("{} is preserved", value));
+    }
+}
+} // namespace
+
+int main()
+{
+    test_consensus();
+    test_wide_or();
+    test_constants();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
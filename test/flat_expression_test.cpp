@@ -0,0 +1,126 @@
+#include <cstdlib>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "expression.hpp"
+#include "flat_expression.hpp"
+#include "input_source.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "simplifier.hpp"
+#include "symbol_table.hpp"
+
+namespace
+{
+using op = flat_expression::op;
+
+int failures = 0;
+
+void check(bool condition, std::string_view what)
+{
+    if (condition)
+        return;
+
+    std::cerr << fmt::format("FAILED: {}\n", what);
+    failures++;
+}
+
+std::unique_ptr<expression> parse(std::string_view text)
+{
+    input_string in(text);
+    lexer lex(in);
+    parser par(lex);
+    return par.parse_expression();
+}
+
+template<typename T>
+std::string print(const T& value, bool debug = false)
+{
+    return debug ? fmt::format("{:d}", value) : fmt::format("{}", value);
+}
+
+void test_round_trip()
+{
+    for (const auto text : {"a", "!a", "a && b", "a || b || c", "!(a && (b || !c)) || (c && !!d)"})
+    {
+        const auto expr = parse(text);
+        check(*unflatten(flatten(*expr)) == *expr, fmt::format("`{}' is preserved", text));
+    }
+}
+
+/**
+ * `push_unary' and `push_binary' accept an index that is already the
+ * operand of another node, which `unflatten' has to copy
+ */
+void test_shared_operands()
+{
+    auto& symbols = symbol_table::instance();
+
+    flat_expression flat;
+    const auto a = flat.push_identifier(symbols.intern("a"));
+    const auto b = flat.push_identifier(symbols.intern("b"));
+    const auto x = flat.push_binary(op::OR, a, b);
+    flat.push_binary(op::AND, x, x);
+
+    const auto expr = unflatten(flat);
+    check(print(*expr) == "(a || b) && (a || b)", "a shared binary operand is copied");
+
+    flat.clear();
+    const auto c = flat.push_identifier(symbols.intern("c"));
+    const auto neg = flat.push_unary(c);
+    flat.push_binary(op::OR, neg, flat.push_unary(neg));
+    check(print(*unflatten(flat)) == "!c || !!c", "a shared unary operand is copied");
+
+    // The tail of a chain that is also used on its own is not gathered
+    // into the chain
+    flat.clear();
+    const auto p = flat.push_identifier(symbols.intern("p"));
+    const auto q = flat.push_identifier(symbols.intern("q"));
+    const auto r = flat.push_identifier(symbols.intern("r"));
+    const auto tail = flat.push_binary(op::OR, q, r);
+    flat.push_binary(op::AND, flat.push_binary(op::OR, p, tail), tail);
+    check(
+        print(*unflatten(flat)) == "(p || (q || r)) && (q || r)",
+        "a shared chain tail is copied");
+}
+
+void test_simplify()
+{
+    for (const auto text :
+         {"!(a && a)", "!(a || !b)", "((b && b) && c) && (b && c)", "!(!(a || b) && (c || !d))"})
+    {
+        const auto expr = parse(text);
+        const auto flat = simplify(flatten(*expr));
+        check(
+            *unflatten(flat) == *simplify(*expr),
+            fmt::format("`{}' simplifies like the tree", text));
+    }
+}
+
+void test_print()
+{
+    for (const auto text : {"a", "!(a && (b || !c)) || (c && !!d)", "a && b && c"})
+    {
+        const auto expr = parse(text);
+        const auto flat = flatten(*expr);
+        check(print(flat) == print(*expr), fmt::format("`{}' prints like the tree", text));
+        check(
+            print(flat, true) == print(*expr, true),
+            fmt::format("`{}' prints like the tree in debug format", text));
+    }
+}
+} // namespace
+
+int main()
+{
+    test_round_trip();
+    test_shared_operands();
+    test_simplify();
+    test_print();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,146 @@
+#include <cstdlib>
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "equivalence.hpp"
+#include "evaluator.hpp"
+#include "expression.hpp"
+#include "input_source.hpp"
+#include "lexer.hpp"
+#include "normal_form.hpp"
+#include "parser.hpp"
+
+namespace
+{
+using binary_kind = expression_binary::kind;
+
+int failures = 0;
+
+void check(bool condition, std::string_view what)
+{
+    if (condition)
+        return;
+
+    std::cerr << fmt::format("FAILED: {}\n", what);
+    failures++;
+}
+
+std::unique_ptr<expression> parse(std::string_view text)
+{
+    input_string in(text);
+    lexer lex(in);
+    parser par(lex);
+    return par.parse_expression();
+}
+
+/**
+ * Returns whether some assignment satisfies `expr', from its truth table
+ */
+bool satisfiable(const expression& expr)
+{
+    for (const auto word : evaluator(expr).truth_table())
+        if (word != 0)
+            return true;
+    return false;
+}
+
+bool equivalent(const expression& left, const expression& right)
+{
+    return check_equivalence(left, right).status == equivalence_status::EQUIVALENT;
+}
+
+void test_equivalent()
+{
+    for (const auto text : {"a", "!(a && b)", "(a && b) || (c && !d)", "!((a || b) && !(c || d))"})
+    {
+        const auto expr = parse(text);
+        const auto cnf = to_cnf(*expr);
+        const auto dnf = to_dnf(*expr);
+
+        check(cnf != nullptr && equivalent(*cnf, *expr), fmt::format("`{}' has a CNF", text));
+        check(dnf != nullptr && equivalent(*dnf, *expr), fmt::format("`{}' has a DNF", text));
+    }
+}
+
+/**
+ * A CNF without clauses and a DNF without terms are spelled out with a
+ * variable and its negation
+ */
+void test_constants()
+{
+    const auto tautology = parse("a || !a");
+    const auto contradiction = parse("a && !a");
+
+    const auto cnf = to_cnf(*tautology);
+    check(cnf != nullptr && *cnf == *tautology, "a tautology has an empty CNF");
+
+    const auto dnf = to_dnf(*contradiction);
+    check(dnf != nullptr && *dnf == *contradiction, "a contradiction has an empty DNF");
+
+    const auto tseitin = to_cnf(*contradiction, cnf_mode::TSEITIN);
+    check(tseitin != nullptr && !satisfiable(*tseitin), "a contradiction stays unsatisfiable");
+}
+
+/**
+ * The CNF of (x0 AND y0) OR ... OR (x11 AND y11) has 2^12 clauses of 12
+ * literals each, while its Tseitin encoding stays linear
+ */
+void test_budget()
+{
+    std::unique_ptr<expression> expr;
+    for (std::size_t i = 0; i < 12; i++)
+    {
+        std::unique_ptr<expression> term = make_binary(
+            binary_kind::AND,
+            make_identifier(fmt::format("x{}", i)),
+            make_identifier(fmt::format("y{}", i)));
+        expr = expr == nullptr ? std::move(term)
+                               : make_binary(binary_kind::OR, std::move(term), std::move(expr));
+    }
+
+    check(to_cnf(*expr, cnf_mode::DISTRIBUTE, 1000) == nullptr, "the CNF exceeds the budget");
+    check(to_cnf(*expr) != nullptr, "the CNF fits in the default budget");
+    check(to_dnf(*expr, 1000) != nullptr, "the DNF fits in the budget");
+    check(to_cnf(*expr, cnf_mode::TSEITIN, 1000) != nullptr, "Tseitin ignores the budget");
+}
+
+/**
+ * The gates of the two encodings are fresh, so their conjunction is
+ * satisfiable like the conjunction of their inputs. With the same gate
+ * names, $1 would have to imply both a and NOT a.
+ */
+void test_tseitin()
+{
+    const auto left = parse("(a && b) || (c && d)");
+    const auto right = parse("(!a && e) || (!c && f)");
+
+    auto left_cnf = to_cnf(*left, cnf_mode::TSEITIN);
+    auto right_cnf = to_cnf(*right, cnf_mode::TSEITIN);
+    check(left_cnf != nullptr && satisfiable(*left_cnf), "the left encoding is satisfiable");
+    check(right_cnf != nullptr && satisfiable(*right_cnf), "the right encoding is satisfiable");
+    if (left_cnf == nullptr || right_cnf == nullptr)
+        return;
+
+    const auto both = make_binary(binary_kind::AND, left->clone(), right->clone());
+    const auto both_cnf = make_binary(binary_kind::AND, std::move(left_cnf), std::move(right_cnf));
+    check(satisfiable(*both), "the conjunction is satisfiable");
+    check(satisfiable(*both_cnf), "the conjunction of the encodings is satisfiable");
+
+    const auto unsat = parse("((a && b) || (c && d)) && !a && !c");
+    const auto unsat_cnf = to_cnf(*unsat, cnf_mode::TSEITIN);
+    check(unsat_cnf != nullptr && !satisfiable(*unsat_cnf), "an unsatisfiable input stays so");
+}
+} // namespace
+
+int main()
+{
+    test_equivalent();
+    test_constants();
+    test_budget();
+    test_tseitin();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,83 @@
+#include <cstdlib>
+
+#include <iostream>
+#include <memory>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "arena.hpp"
+#include "expression.hpp"
+#include "input_source.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "simplifier.hpp"
+#include "simplify_cache.hpp"
+#include "task_pool.hpp"
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, std::string_view what)
+{
+    if (condition)
+        return;
+
+    std::cerr << fmt::format("FAILED: {}\n", what);
+    failures++;
+}
+
+std::unique_ptr<expression> parse(std::string_view text)
+{
+    input_string in(text);
+    lexer lex(in);
+    parser par(lex);
+    return par.parse_expression();
+}
+
+/**
+ * Checks that every overload of `simplify' turns `text' into `expected'
+ */
+void check_simplify(std::string_view text, std::string_view expected)
+{
+    const auto expr = parse(text);
+    const auto want = parse(expected);
+
+    simplify_cache cache;
+    expression_arena arena;
+    task_pool pool(2);
+
+    check(*simplify(*expr) == *want, fmt::format("`{}' simplifies to `{}'", text, expected));
+    check(*simplify(*expr, cache) == *want, fmt::format("`{}' with a cache", text));
+    check(*simplify(*expr, arena) == *want, fmt::format("`{}' in an arena", text));
+    check(*simplify(*expr, pool) == *want, fmt::format("`{}' on a pool", text));
+    check(*simplify(expr->clone()) == *want, fmt::format("`{}' in place", text));
+}
+
+/**
+ * <EXPR1> [AND/OR] <EXPR1> -> <EXPR1> compares the simplified operands,
+ * so operands that only become equal once simplified are folded too
+ */
+void test_idempotence()
+{
+    check_simplify("!(a && a)", "!a");
+    check_simplify("(b && b) && b", "b");
+    check_simplify("((b && b) && c) && (b && c)", "b && c");
+    check_simplify("!(((b && b) && c) && (b && c))", "!b || !c");
+}
+
+void test_de_morgan()
+{
+    check_simplify("!!a", "a");
+    check_simplify("!(a && b)", "!a || !b");
+    check_simplify("!(a || !b)", "!a && b");
+}
+} // namespace
+
+int main()
+{
+    test_idempotence();
+    test_de_morgan();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,70 @@
+#include <cstdlib>
+
+#include <iostream>
+#include <string_view>
+
+#include <fmt/format.h>
+
+#include "expression.hpp"
+#include "expression_table.hpp"
+#include "simplify_cache.hpp"
+
+namespace
+{
+int failures = 0;
+
+void check(bool condition, std::string_view what)
+{
+    if (condition)
+        return;
+
+    std::cerr << fmt::format("FAILED: {}\n", what);
+    failures++;
+}
+
+void test_hit()
+{
+    simplify_cache cache;
+    const auto expr = make_identifier("a");
+
+    // Results are only copied in the second time they are inserted
+    cache.insert(expr->id(), false, *expr, 1);
+    cache.insert(expr->id(), false, *expr, 1);
+
+    const auto* hit = cache.find(expr->id(), false);
+    check(hit != nullptr && *hit->expr == *expr, "a result is found by its id");
+    check(cache.find(expr->id(), true) == nullptr, "the negated form is not");
+}
+
+/**
+ * Ids start over from 1 after `expression_table::clear', so the cached
+ * result for the old holder of an id must not come back for the new one
+ */
+void test_table_cleared()
+{
+    simplify_cache cache;
+    auto& table = expression_table::instance();
+
+    table.clear();
+    const auto old_id = make_identifier("a")->id();
+    {
+        const auto expr = make_identifier("a");
+        cache.insert(expr->id(), false, *expr, 1);
+        cache.insert(expr->id(), false, *expr, 1);
+    }
+    check(cache.find(old_id, false) != nullptr, "the result is cached before the clear");
+
+    table.clear();
+    const auto expr = make_identifier("b");
+    check(expr->id() == old_id, "ids are handed out again after the clear");
+    check(cache.find(expr->id(), false) == nullptr, "the result is gone after the clear");
+    check(cache.size() == 0, "the cache is flushed after the clear");
+}
+} // namespace
+
+int main()
+{
+    test_hit();
+    test_table_cleared();
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}